@@ -88,12 +88,14 @@ class HGDBClient:
         return res
 
     async def set_breakpoint(self, filename, line_num, column_num=0, token="", cond="",
-                             check_error=True):
+                             check_error=True, hit_count=""):
         payload = {"request": True, "type": "breakpoint", "token": token,
                    "payload": {"filename": filename, "line_num": line_num, "column_num": column_num,
                                "action": "add"}}
         if len(cond) > 0:
             payload["payload"]["condition"] = cond
+        if len(hit_count) > 0:
+            payload["payload"]["hit_count"] = hit_count
         return await self.__send_check(payload, check_error)
 
     async def set_data_breakpoint(self, breakpoint_id, var_name, token="", cond="", check_error=True):
@@ -206,6 +208,24 @@ class HGDBClient:
             payload["payload"]["instance_id"] = instance_id
         return await self.__send_check(payload, check_error=check_error)
 
+    async def find_when(self, expression, start_time=None, end_time=None, limit=None, namespace_id=None,
+                        instance_id=None, breakpoint_id=None):
+        payload = {"request": True, "type": "find-when",
+                   "payload": {"expression": expression}}
+        for name, value in (("start_time", start_time), ("end_time", end_time), ("limit", limit),
+                            ("namespace_id", namespace_id), ("instance_id", instance_id),
+                            ("breakpoint_id", breakpoint_id)):
+            if value is not None:
+                payload["payload"][name] = value
+        # matches are streamed back over multiple responses
+        res = await self.__send_check(payload, True)
+        times = res["payload"]["times"]
+        while not res["payload"]["done"]:
+            res = await self.recv()
+            self.__check_status(res)
+            times += res["payload"]["times"]
+        return times
+
     async def change_option(self, check_error=True, **kwargs):
         payload = {"request": True, "type": "option-change", "payload": {}}
         for name, value in kwargs.items():
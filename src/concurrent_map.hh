@@ -0,0 +1,111 @@
+#ifndef HGDB_CONCURRENT_MAP_HH
+#define HGDB_CONCURRENT_MAP_HH
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace hgdb {
+
+// read-mostly hash map. lookups are lock-free and can be issued from any thread, while inserts
+// are serialized. entries are never removed, so a pointer to a value stays valid for the
+// lifetime of the map. values are not protected by the map: anything that changes after the
+// insert has to be atomic. when the table grows a new one is published as a whole and the
+// retired tables are kept alive, since concurrent readers may still hold them
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentMap {
+public:
+    ConcurrentMap() {
+        tables_.emplace_back(std::make_unique<Table>(initial_capacity));
+        table_.store(tables_.back().get());
+    }
+
+    Value *find(const Key &key) const {
+        auto *node = find(table_.load(std::memory_order_acquire), key);
+        return node ? &node->value : nullptr;
+    }
+
+    // value is constructed from args only if the key is not present yet. returns the value
+    // stored under the key and whether it was inserted
+    template <typename... Args>
+    std::pair<Value *, bool> emplace(const Key &key, Args &&...args) {
+        std::lock_guard guard(lock_);
+        auto *table = table_.load(std::memory_order_relaxed);
+        if (auto *node = find(table, key)) return {&node->value, false};
+        // keep the load factor under 1/2 so probing stays short
+        if ((nodes_.size() + 1) * 2 > table->mask + 1) [[unlikely]] {
+            tables_.emplace_back(std::make_unique<Table>((table->mask + 1) * 2));
+            table = tables_.back().get();
+            for (auto &node : nodes_) insert(table, &node);
+            table_.store(table, std::memory_order_release);
+        }
+        auto &node = nodes_.emplace_back(key, std::forward<Args>(args)...);
+        insert(table, &node);
+        return {&node.value, true};
+    }
+
+    [[nodiscard]] uint64_t size() const {
+        std::lock_guard guard(lock_);
+        return nodes_.size();
+    }
+
+    ConcurrentMap(const ConcurrentMap &) = delete;
+    ConcurrentMap &operator=(const ConcurrentMap &) = delete;
+
+private:
+    struct Node {
+        template <typename... Args>
+        explicit Node(const Key &key, Args &&...args)
+            : key(key), value(std::forward<Args>(args)...) {}
+
+        const Key key;
+        Value value;
+    };
+
+    struct Table {
+        explicit Table(uint64_t capacity)
+            : mask(capacity - 1), slots(std::make_unique<std::atomic<Node *>[]>(capacity)) {}
+        uint64_t mask;
+        std::unique_ptr<std::atomic<Node *>[]> slots;
+    };
+
+    std::atomic<Table *> table_;
+    std::vector<std::unique_ptr<Table>> tables_;
+    // deque keeps the nodes in place as the map grows
+    std::deque<Node> nodes_;
+    mutable std::mutex lock_;
+
+    static constexpr uint64_t initial_capacity = 64;
+
+    static uint64_t slot(const Key &key) {
+        // fibonacci hashing on top, since pointer keys are usually aligned
+        auto hash = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return hash ^ (hash >> 32);
+    }
+
+    static Node *find(const Table *table, const Key &key) {
+        for (auto i = slot(key);; i++) {
+            auto *node = table->slots[i & table->mask].load(std::memory_order_acquire);
+            if (!node) return nullptr;
+            if (node->key == key) return node;
+        }
+    }
+
+    static void insert(Table *table, Node *node) {
+        for (auto i = slot(node->key);; i++) {
+            auto &entry = table->slots[i & table->mask];
+            if (!entry.load(std::memory_order_relaxed)) {
+                entry.store(node, std::memory_order_release);
+                return;
+            }
+        }
+    }
+};
+
+}  // namespace hgdb
+
+#endif  // HGDB_CONCURRENT_MAP_HH
@@ -1,5 +1,7 @@
 #include "debug.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <functional>
 #include <thread>
@@ -17,8 +19,16 @@ constexpr auto DEBUG_LOGGING_ENV = "DEBUG_LOG";
 constexpr auto DEBUG_PERF_COUNT = "DEBUG_PERF_COUNT";
 constexpr auto DEBUG_BREAKPOINT_ENV = "DEBUG_BREAKPOINT{0}";
 constexpr auto DEBUG_PERF_COUNT_LOG = "DEBUG_PERF_COUNT_LOG";
+constexpr auto DEBUG_EVAL_THREADS = "DEBUG_EVAL_THREADS";
+constexpr auto DEBUG_WARM_UP_HANDLES = "DEBUG_WARM_UP_HANDLES";
 
 namespace hgdb {
+// passed to clock callbacks so that each clock knows which partition to evaluate
+struct ClockDomainCallback {
+    Debugger *debugger;
+    uint32_t clock_domain;
+};
+
 Debugger::Debugger() : Debugger(nullptr) {}
 
 Debugger::Debugger(std::shared_ptr<AVPIProvider> vpi) {
@@ -28,6 +38,8 @@ Debugger::Debugger(std::shared_ptr<AVPIProvider> vpi) {
     server_ = std::make_unique<DebugServer>();
     log_enabled_ = get_logging();
     perf_count_ = get_perf_count();
+    evaluation_threads_ = get_evaluation_threads();
+    warm_up_handles_ = get_test_plus_arg(DEBUG_WARM_UP_HANDLES, true);
 
     // set up some call backs
     server_->set_on_call_client_disconnect([this]() {
@@ -49,6 +61,7 @@ void Debugger::initialize_db(std::unique_ptr<SymbolTableProvider> db) {
     db_ = nullptr;
     if (!db) return;
     db_ = std::move(db);
+    hit_plans_.clear();
 
     // set up the name mapping
     namespaces_.compute_instance_mapping(db_.get());
@@ -67,6 +80,8 @@ void Debugger::initialize_db(std::unique_ptr<SymbolTableProvider> db) {
         return namespaces_.default_rtl()->get_value(symbol_name);
     });
 
+    if (warm_up_handles_) warm_up_handles();
+
     // setup breakpoints from env
     setup_init_breakpoint_from_env();
 }
@@ -93,7 +108,7 @@ void Debugger::run() {
     // rocket chip doesn't like plus args. Need to
     bool disable_blocking = get_test_plus_arg(DISABLE_BLOCKING_ENV, true);
     if (!disable_blocking) [[likely]] {
-        lock_.wait();
+        pause();
     }
 }
 
@@ -105,11 +120,16 @@ void Debugger::stop() {
     }
 }
 
-void Debugger::eval() {
+void Debugger::eval(std::optional<uint32_t> clock_domain) {
     perf::PerfCount perf("eval loop", perf_count_);
     // if we set to pause at posedge, need to do that at the very beginning!
     if (pause_at_posedge) [[unlikely]] {
-        lock_.wait();
+        pause();
+    }
+    // nothing is inside its time window. skip the evaluation entirely
+    if (outside_time_windows()) [[unlikely]] {
+        if (idle_mode_) enter_idle();
+        return;
     }
     // the function that actually triggers breakpoints!
     // notice that there is a hidden race condition
@@ -117,7 +137,7 @@ void Debugger::eval() {
     // however, the server side can still take breakpoint requests, hence modifying the
     // breakpoints_.
     log_info("Start breakpoint evaluation...");
-    start_breakpoint_evaluation();  // clean the state and fetch values
+    start_breakpoint_evaluation(clock_domain);  // clean the state and fetch values
 
     // main loop to fetch breakpoints
     while (true) {
@@ -142,11 +162,14 @@ void Debugger::eval() {
             // also send any breakpoint values
             send_monitor_values(MonitorRequest::MonitorType::breakpoint);
             // then pause the execution
-            lock_.wait();
+            pause();
         }
     }
 
     send_monitor_values(MonitorRequest::MonitorType::clock_edge);
+    end_breakpoint_evaluation();
+
+    if (idle_mode_) enter_idle();
 }
 
 [[maybe_unused]] bool Debugger::is_verilator() {
@@ -192,6 +215,7 @@ void Debugger::handle_assert() {
 void Debugger::set_option(const std::string &name, bool value) {
     auto options = get_options();
     options.set_option(name, value);
+    request_exit_idle();
 }
 
 void Debugger::set_on_client_connected(
@@ -201,6 +225,25 @@ void Debugger::set_on_client_connected(
 
 Debugger::~Debugger() {
     if (server_thread_.joinable()) server_thread_.join();
+    std::lock_guard guard(find_when_lock_);
+    cancel_find_when();
+}
+
+void Debugger::pause() {
+    paused_ = true;
+    lock_.wait();
+    // any search still reading the signal history has to be done before the simulation
+    // touches the provider again
+    std::lock_guard guard(find_when_lock_);
+    paused_ = false;
+    cancel_find_when();
+    // requests handled while paused may need the clock callbacks back
+    exit_idle();
+}
+
+void Debugger::cancel_find_when() {
+    find_when_cancel_ = true;
+    if (find_when_thread_.joinable()) find_when_thread_.join();
 }
 
 void Debugger::detach() {
@@ -212,18 +255,18 @@ void Debugger::detach() {
         rtl->remove_call_back("eval_hgdb");
         log_info("Remove callback eval_hgdb");
     } else {
-        std::set<std::string> callbacks;
-        auto const callback_names = rtl->callback_names();
-        for (auto const &callback_name : callback_names) {
-            if (callback_name.find("Monitor") != std::string::npos) {
-                log_info("Remove callback " + callback_name);
-                rtl->remove_call_back(callback_name);
-            }
-        }
+        std::lock_guard guard(clock_cb_lock_);
+        remove_clock_callbacks();
+        remove_idle_wake_up();
+        idle_ = false;
+        idle_perf_ = nullptr;
     }
 
     // set evaluation mode to normal
-    if (scheduler_) scheduler_->set_evaluation_mode(Scheduler::EvaluationMode::None);
+    if (scheduler_) {
+        scheduler_->set_evaluation_mode(Scheduler::EvaluationMode::None);
+        scheduler_->set_change_driven(false);
+    }
 
     // print out perf if enabled
     if (perf_count_) {
@@ -325,7 +368,14 @@ void Debugger::on_message(const std::string &message, uint64_t conn_id) {
             handle_data_breakpoint(*r, conn_id);
             break;
         }
+        case RequestType::find_when: {
+            auto *r = reinterpret_cast<FindWhenRequest *>(req.get());
+            handle_find_when(*r, conn_id);
+            break;
+        }
     }
+    // the request may have added something to evaluate
+    request_exit_idle();
     log_info("Done handling " + to_string(req->type()));
 }
 
@@ -399,6 +449,62 @@ bool Debugger::get_logging() {
 
 bool Debugger::get_perf_count() { return get_test_plus_arg(DEBUG_PERF_COUNT, true); }
 
+void Debugger::warm_up_handles() {
+    auto const start = std::chrono::steady_clock::now();
+    // the symbol table is not thread safe, so every RTL name it references is collected
+    // up front. names are the same for every namespace before they are mapped
+    auto *rtl = namespaces_.default_rtl();
+    std::unordered_set<std::string> unique_names;
+    auto add_name = [&](const std::string &name, const std::optional<std::string> &scoped) {
+        unique_names.emplace(!rtl->is_absolute_path(name) && scoped ? *scoped : name);
+    };
+    std::unordered_set<uint32_t> instance_ids;
+    for (auto bp_id : db_->execution_bp_orders()) {
+        for (auto const &[ctx_var, var] : db_->get_context_variables(bp_id)) {
+            if (!var.is_rtl) continue;
+            add_name(var.value, db_->resolve_scoped_name_breakpoint(var.value, bp_id));
+        }
+        auto bp = db_->get_breakpoint(bp_id);
+        if (!bp || !bp->instance_id || !instance_ids.emplace(*bp->instance_id).second) continue;
+        for (auto const &[gen_var, var] : db_->get_generator_variable(*bp->instance_id)) {
+            if (!var.is_rtl) continue;
+            add_name(var.value, db_->resolve_scoped_name_instance(var.value, *bp->instance_id));
+        }
+    }
+    std::vector<std::string> names(unique_names.begin(), unique_names.end());
+
+    const static auto commercial = rtl->is_vcs() || rtl->is_xcelium();
+    auto num_threads =
+        commercial ? 1u : static_cast<uint32_t>(std::max<int64_t>(evaluation_threads_, 1));
+    ThreadPool pool(num_threads);
+    uint64_t num_resolved = 0;
+    for (auto const &ns : namespaces_) {
+        num_resolved += ns->rtl->resolve_handles(
+            names, pool, [&ns](uint64_t done, uint64_t total) {
+                log::log(log::log_level::info,
+                         fmt::format("Resolving handles for namespace {0}: {1}/{2}", ns->id, done,
+                                     total));
+            });
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    log::log(log::log_level::info,
+             fmt::format("Resolved {0}/{1} RTL handles in {2} ms with {3} threads", num_resolved,
+                         names.size() * namespaces_.size(), elapsed.count(), num_threads));
+}
+
+int64_t Debugger::get_evaluation_threads() {
+    auto value = get_value_plus_arg(DEBUG_EVAL_THREADS, true);
+    if (!value) return default_evaluation_threads;
+    auto num_threads = util::stol(*value);
+    if (!num_threads || *num_threads < 1) {
+        log_error(fmt::format("Invalid number of evaluation threads: {0}", *value));
+        return default_evaluation_threads;
+    }
+    return *num_threads;
+}
+
 void Debugger::log_error(const std::string &msg) { log::log(log::log_level::error, msg); }
 
 void Debugger::log_info(const std::string &msg) const {
@@ -440,36 +546,6 @@ std::string value_to_str(std::optional<int64_t> value, bool use_hex, uint32_t wi
 }
 
 // NOLINTNEXTLINE
-std::string Debugger::get_value_str(uint32_t ns_id, const std::string &rtl_name, bool is_rtl,
-                                    bool use_delay) {
-    std::string value_str;
-    if (is_rtl) {
-        auto &rtl = namespaces_[ns_id]->rtl;
-        auto *handle = rtl->get_handle(rtl_name);
-        uint32_t width = 0;
-        // width is only used for hex string
-        if (use_hex_str_) [[unlikely]] {
-            auto width_opt = rtl->get_signal_width(handle);
-            width = width_opt ? *width_opt : 0u;
-        }
-
-        if (use_delay) {
-            if (delayed_variables_.find(handle) == delayed_variables_.end()) [[unlikely]] {
-                log_error("Internal error on handling delayed variables");
-                value_str = error_value_str;
-            } else {
-                value_str = value_to_str(delayed_variables_.at(handle).value, use_hex_str_, width);
-            }
-        } else {
-            auto value = rtl->get_value(handle);
-            value_str = value_to_str(value, use_hex_str_, width);
-        }
-    } else {
-        value_str = rtl_name;
-    }
-    return value_str;
-}
-
 std::optional<std::string> Debugger::resolve_var_name(
     uint32_t ns_id, const std::string &var_name, const std::optional<uint64_t> &instance_id,
     const std::optional<uint64_t> &breakpoint_id) {
@@ -497,9 +573,9 @@ PLI_INT32 eval_hgdb_on_clk(p_cb_data cb_data) {
     // only if the clock value is high
     auto value = cb_data->value->value.integer;
     if (value) {
-        auto *raw_debugger = cb_data->user_data;
-        auto *debugger = reinterpret_cast<hgdb::Debugger *>(raw_debugger);
-        debugger->eval();
+        auto *raw_data = cb_data->user_data;
+        auto *data = reinterpret_cast<hgdb::ClockDomainCallback *>(raw_data);
+        data->debugger->eval(data->clock_domain);
     }
 
     return 0;
@@ -561,10 +637,8 @@ void Debugger::handle_breakpoint(const BreakPointRequest &req, uint64_t conn_id)
         }
 
         for (auto const &bp : bps) {
-            add_breakpoint(bp_info, bp);
+            add_breakpoint(bp_info, bp, req.hit_count(), req.time_window());
         }
-
-        scheduler_->reorder_breakpoints();
     } else {
         // remove
         auto bps = db_->get_breakpoints(bp_info.filename, bp_info.line_num, bp_info.column_num);
@@ -593,7 +667,7 @@ void Debugger::handle_breakpoint_id(const BreakPointIDRequest &req, uint64_t con
             send_message(error_response.str(log_enabled_), conn_id);
             return;
         }
-        add_breakpoint(bp_info, *bp);
+        add_breakpoint(bp_info, *bp, req.hit_count(), req.time_window());
     } else {
         scheduler_->remove_breakpoint(bp_info, DebugBreakPoint::Type::normal);
     }
@@ -675,6 +749,9 @@ void Debugger::handle_command(const CommandRequest &req, uint64_t conn_id) {
                 status = status_code::error;
                 error = "Underlying RTL simulator does not support rewind";
                 log_error(error);
+            } else {
+                // values changed without any value change callback
+                scheduler_->clear_cached_results();
             }
             lock_.ready();
             break;
@@ -848,8 +925,10 @@ void Debugger::handle_evaluation(const EvaluationRequest &req, uint64_t conn_id)
             return;
         }
 
-        auto value = expr.eval();
-        EvaluationResponse eval_resp(std::to_string(value));
+        // wide values are only printed in hex when they don't fit in 64 bits
+        auto value = expr.eval_wide();
+        auto narrow = value.narrow();
+        EvaluationResponse eval_resp(narrow ? std::to_string(*narrow) : value.hex_str());
         req.set_token(eval_resp);
         send_message(eval_resp.str(log_enabled_), conn_id);
         return;
@@ -858,6 +937,139 @@ void Debugger::handle_evaluation(const EvaluationRequest &req, uint64_t conn_id)
     }
 }
 
+void Debugger::handle_find_when(const FindWhenRequest &req, uint64_t conn_id) {
+    if (!db_ || req.status() != status_code::success) [[unlikely]] {
+        send_error(req, req.error_reason(), conn_id);
+        return;
+    }
+    // the search runs asynchronously so that the server can still handle other requests,
+    // e.g. stop
+    std::lock_guard guard(find_when_lock_);
+    if (!paused_) {
+        send_error(req, "Simulation has to be paused", conn_id);
+        return;
+    }
+    // a new search replaces the running one
+    cancel_find_when();
+    find_when_cancel_ = false;
+    find_when_thread_ = std::thread([this, req, conn_id]() { find_when(req, conn_id); });
+}
+
+void Debugger::find_when(const FindWhenRequest &req, uint64_t conn_id) {
+    DebugExpression expr(req.expression());
+    if (!expr.correct()) {
+        send_error(req, "Invalid expression", conn_id);
+        return;
+    }
+    auto *ns = get_namespace(req.instance_id(), req.breakpoint_id(), req.namespace_id(),
+                             namespaces_, db_.get());
+    if (!ns) ns = namespaces_.default_namespace();
+    // same scoping rule as evaluation
+    if (req.instance_id() || req.breakpoint_id()) {
+        util::validate_expr(ns->rtl.get(), db_.get(), &expr, req.breakpoint_id(),
+                            req.instance_id());
+    } else {
+        find_matching_namespace_validate(expr, db_.get(), std::nullopt, std::nullopt,
+                                         namespaces_);
+    }
+    if (!expr.correct()) {
+        send_error(req, "Unable to resolve symbols", conn_id);
+        return;
+    }
+    if (expr.wide()) {
+        send_error(req, "Signals wider than 64 bits are not supported", conn_id);
+        return;
+    }
+
+    using Kind = DebugExpression::SymbolBinding::Kind;
+    std::optional<uint32_t> time_slot;
+    std::vector<DebugExpression::SymbolBinding> signals;
+    for (auto const &binding : expr.get_resolved_symbol_handles()) {
+        if (binding.kind == Kind::instance) {
+            expr.set_value(binding.slot, req.instance_id() ? *req.instance_id() : 0);
+        } else if (binding.kind == Kind::time) {
+            time_slot = binding.slot;
+        } else {
+            signals.emplace_back(binding);
+        }
+    }
+
+    // signal histories are fetched in waves so that memory stays bounded on long traces. the
+    // span of each wave adapts to how dense the value changes are. providers are not thread
+    // safe, so only the evaluation is split across threads
+    auto constexpr initial_span = 1ull << 16u;
+    auto constexpr target_changes = 1ull << 20u;
+    auto constexpr minimum_batch_size = 1024u;
+    auto const num_threads = static_cast<uint32_t>(std::max<int64_t>(evaluation_threads_, 1));
+    auto const &window = req.time_window();
+    auto const limit = req.limit() ? *req.limit() : std::numeric_limits<uint64_t>::max();
+    auto &rtl = ns->rtl;
+    std::unique_ptr<ThreadPool> pool;
+    uint64_t span = initial_span;
+    uint64_t num_found = 0;
+    auto wave_start = window.start;
+    auto first_wave = true;
+    while (true) {
+        auto wave_end = window.end - wave_start <= span ? window.end : wave_start + span;
+        std::vector<SlotValueChanges> changes(signals.size());
+        uint64_t num_changes = 0;
+        for (auto i = 0u; i < signals.size(); i++) {
+            if (find_when_cancel_) [[unlikely]] {
+                send_error(req, "Search cancelled since the simulation resumed", conn_id);
+                return;
+            }
+            changes[i].slot = signals[i].slot;
+            if (!rtl->get_value_changes(signals[i].handle, wave_start, wave_end,
+                                        changes[i].changes)) {
+                send_error(req, "Signal history is not available", conn_id);
+                return;
+            }
+            num_changes += changes[i].changes.size();
+        }
+        if (num_changes < target_changes / 2 && span <= std::numeric_limits<uint64_t>::max() / 2) {
+            span *= 2;
+        } else if (num_changes > target_changes * 2 && span > 1) {
+            span /= 2;
+        }
+
+        ValueChangeSearch search(expr, std::move(changes), wave_start, wave_end, first_wave,
+                                 time_slot);
+        std::vector<uint64_t> times;
+        auto workers = std::min<uint64_t>(num_threads, search.size() / minimum_batch_size);
+        if (workers > 1) {
+            if (!pool) pool = std::make_unique<ThreadPool>(num_threads);
+            auto batch_size =
+                std::max<uint64_t>(minimum_batch_size, search.size() / (num_threads * 4));
+            // batches are aligned, so matches can be stitched back together in time order
+            std::vector<std::vector<uint64_t>> batch_times((search.size() + batch_size - 1) /
+                                                           batch_size);
+            pool->parallel_for(search.size(), batch_size, [&](uint64_t start, uint64_t end) {
+                search.search(start, end, batch_times[start / batch_size]);
+            });
+            for (auto const &batch : batch_times) {
+                times.insert(times.end(), batch.begin(), batch.end());
+            }
+        } else {
+            search.search(0, search.size(), times);
+        }
+
+        auto done = wave_end == window.end;
+        if (times.size() >= limit - num_found) {
+            times.resize(limit - num_found);
+            done = true;
+        }
+        num_found += times.size();
+        if (!times.empty() || done) {
+            FindWhenResponse resp(std::move(times), done);
+            req.set_token(resp);
+            send_message(resp.str(log_enabled_), conn_id);
+        }
+        if (done) break;
+        wave_start = wave_end;
+        first_wave = false;
+    }
+}
+
 void Debugger::handle_option_change(const OptionChangeRequest &req, uint64_t conn_id) {
     if (req.status() == status_code::success) {
         auto options = get_options();
@@ -895,6 +1107,7 @@ void Debugger::handle_monitor(const MonitorRequest &req, uint64_t conn_id) {
                 return;
             }
             auto track_id = monitor.add_monitor_variable(*full_name, req.monitor_type());
+            monitor.set_monitor_variable_window(track_id, req.time_window());
             auto resp = GenericResponse(status_code::success, req);
             resp.set_value("track_id", track_id);
             resp.set_value("namespace_id", ns->id);
@@ -941,14 +1154,7 @@ void Debugger::handle_set_value(const SetValueRequest &req, uint64_t conn_id) {
         // need to set the value
         auto res = rtl->set_value(*full_name, req.value());
         if (res) {
-            // we need to remove cached value
-            if (use_signal_cache_) {
-                auto *handle = rtl->get_handle(*full_name);
-                std::lock_guard guard(cached_signal_values_lock_);
-                if (cached_signal_values_.find(handle) != cached_signal_values_.end()) {
-                    cached_signal_values_.erase(handle);
-                }
-            }
+            // notice that the RTL client drops the cached value by itself
             auto resp = GenericResponse(status_code::success, req);
             send_message(resp.str(log_enabled_), conn_id);
             return;
@@ -1022,8 +1228,8 @@ void Debugger::handle_data_breakpoint(const DataBreakpointRequest &req, uint64_t
                 else
                     // merge these two
                     bp_condition = fmt::format("{0} && {1}", req.condition(), data_condition);
-                auto *bp =
-                    scheduler_->add_data_breakpoint(var_name, bp_condition, *bp_opt, dry_run);
+                auto *bp = scheduler_->add_data_breakpoint(var_name, bp_condition, *bp_opt, dry_run,
+                                                           req.time_window());
                 if (!bp) {
                     send_error(req, "Invalid data breakpoint expression/data_condition", conn_id);
                     return;
@@ -1051,21 +1257,18 @@ void Debugger::handle_data_breakpoint(const DataBreakpointRequest &req, uint64_t
                 }
             }
 
-            // sort the breakpoints
-            scheduler_->reorder_breakpoints();
-
             // tell client we're good
             auto success_resp = GenericResponse(status_code::success, req);
             send_message(success_resp.str(log_enabled_), conn_id);
             break;
         }
         case DataBreakpointRequest::Action::remove: {
-            auto watch_id = scheduler_->remove_data_breakpoint(req.breakpoint_id());
+            auto watches = scheduler_->remove_data_breakpoint(req.breakpoint_id());
             // remove from monitor as well
-            if (watch_id) {
-                auto &monitor = ns->monitor;
-                monitor->remove_monitor_variable(*watch_id);
-                log_info(fmt::format("Remove watch variable with ID {0}", *watch_id));
+            for (auto const &[ns_id, watch_id] : watches) {
+                auto &monitor = namespaces_[ns_id]->monitor;
+                monitor->remove_monitor_variable(watch_id);
+                log_info(fmt::format("Remove watch variable with ID {0}", watch_id));
             }
             // tell client we're good
             auto success_resp = GenericResponse(status_code::success, req);
@@ -1101,25 +1304,81 @@ std::vector<std::pair<std::string, std::string>> resolve_context_name(std::strin
     return var_names;
 }
 
+Debugger::BreakPointHitPlan &Debugger::get_hit_plan(const DebugBreakPoint *bp) {
+    auto key = (static_cast<uint64_t>(bp->id) << 32) | bp->ns_id;
+    auto pos = hit_plans_.find(key);
+    if (pos != hit_plans_.end()) [[likely]]
+        return pos->second;
+
+    auto bp_id = bp->id;
+    auto *rtl = namespaces_[bp->ns_id]->rtl.get();
+    auto generator_values = db_->get_generator_variable(bp->instance_id);
+    auto context_values = db_->get_context_variables(bp_id);
+    auto instance_name = db_->get_instance_name_from_bp(bp_id);
+
+    BreakPointHitPlan plan;
+    // we use full name to distinguish among IP instantiations
+    plan.instance_name = rtl->get_full_name(instance_name ? *instance_name : "");
+
+    auto add_variable = [&](const std::string &front_name, const std::string &rtl_name,
+                            bool is_rtl, bool is_generator, bool use_delay) {
+        auto &var = plan.variables.emplace_back();
+        var.front_name = front_name;
+        var.rtl_name = rtl_name;
+        var.is_rtl = is_rtl;
+        var.is_generator = is_generator;
+        var.use_delay = use_delay;
+        if (!is_rtl) return;
+        var.handle = rtl->get_handle(rtl_name);
+        if (!use_delay) {
+            var.value_index = plan.handles.size();
+            plan.handles.emplace_back(var.handle);
+        }
+    };
+
+    for (auto const &[gen_var, var] : generator_values) {
+        // maybe need to resolve the name based on the variable
+        auto var_names =
+            resolve_generator_name(var.value, gen_var.name, bp->instance_id, rtl, db_.get());
+        for (auto const &[front_name, rtl_name] : var_names) {
+            add_variable(front_name, rtl_name, var.is_rtl, true, false);
+        }
+    }
+
+    for (auto const &[ctx_var, var] : context_values) {
+        auto var_names = resolve_context_name(var.value, ctx_var.name, bp_id, rtl, db_.get());
+        using VariableType = SymbolTableProvider::VariableType;
+        auto use_delay = static_cast<VariableType>(ctx_var.type) == VariableType::delay;
+        for (auto const &[front_name, rtl_name] : var_names) {
+            add_variable(front_name, rtl_name, var.is_rtl, false, use_delay);
+        }
+    }
+
+    return hit_plans_.emplace(key, std::move(plan)).first->second;
+}
+
 void Debugger::send_breakpoint_hit(const std::vector<const DebugBreakPoint *> &bps) {
     // we send it here to avoid a round trip of client asking for context and send it
     // back
+    auto resp = get_breakpoint_hit_response(bps);
+    auto str = resp.str(log_enabled_);
+    send_message(str);
+}
+
+BreakPointResponse Debugger::get_breakpoint_hit_response(
+    const std::vector<const DebugBreakPoint *> &bps) {
     auto const *first_bp = bps.front();
     BreakPointResponse resp(namespaces_.default_rtl()->get_simulation_time(), first_bp->filename,
                             first_bp->line_num, first_bp->column_num);
+    std::vector<std::optional<int64_t>> values;
     for (auto const *bp : bps) {
-        // first need to query all the values
-        auto bp_id = bp->id;
+        auto &plan = get_hit_plan(bp);
         auto *rtl = namespaces_[bp->ns_id]->rtl.get();
-        auto generator_values = db_->get_generator_variable(bp->instance_id);
-        auto context_values = db_->get_context_variables(bp_id);
-        auto bp_ptr = db_->get_breakpoint(bp_id);
-        auto instance_name = db_->get_instance_name_from_bp(bp_id);
-        auto instance_name_str = instance_name ? *instance_name : "";
-        // we use full name to distinguish among IP instantiations
-        instance_name_str = rtl->get_full_name(instance_name_str);
-
-        BreakPointResponse::Scope scope(bp->instance_id, instance_name_str, bp_id, bp->ns_id);
+        // first need to query all the values
+        values.resize(plan.handles.size());
+        rtl->get_values(plan.handles, values);
+
+        BreakPointResponse::Scope scope(bp->instance_id, plan.instance_name, bp->id, bp->ns_id);
         switch (bp->type) {
             case DebugBreakPoint::Type::data:
                 scope.bp_type = "data";
@@ -1130,32 +1389,37 @@ void Debugger::send_breakpoint_hit(const std::vector<const DebugBreakPoint *> &b
                 break;
         }
 
-        using namespace std::string_literals;
-        for (auto const &[gen_var, var] : generator_values) {
-            // maybe need to resolve the name based on the variable
-            auto var_names =
-                resolve_generator_name(var.value, gen_var.name, bp->instance_id, rtl, db_.get());
-            for (auto const &[front_name, rtl_name] : var_names) {
-                std::string value_str = get_value_str(bp->ns_id, rtl_name, var.is_rtl);
-                scope.add_generator_value(front_name, value_str);
+        for (auto &var : plan.variables) {
+            std::string value_str;
+            uint32_t width = 0;
+            // width is only used for hex string
+            if (var.is_rtl && use_hex_str_) [[unlikely]] {
+                if (!var.width) var.width = rtl->get_signal_width(var.handle).value_or(0u);
+                width = *var.width;
+            }
+            if (!var.is_rtl) {
+                value_str = var.rtl_name;
+            } else if (var.use_delay) {
+                auto delayed = delayed_variables_.find(var.handle);
+                if (delayed == delayed_variables_.end()) [[unlikely]] {
+                    log_error("Internal error on handling delayed variables");
+                    value_str = error_value_str;
+                } else {
+                    value_str = value_to_str(delayed->second.value, use_hex_str_, width);
+                }
+            } else {
+                value_str = value_to_str(values[var.value_index], use_hex_str_, width);
             }
-        }
 
-        for (auto const &[ctx_var, var] : context_values) {
-            auto var_names = resolve_context_name(var.value, ctx_var.name, bp->id, rtl, db_.get());
-            for (auto const &[front_name, rtl_name] : var_names) {
-                using VariableType = SymbolTableProvider::VariableType;
-                std::string value_str =
-                    get_value_str(bp->ns_id, rtl_name, var.is_rtl,
-                                  static_cast<VariableType>(ctx_var.type) == VariableType::delay);
-                scope.add_local_value(front_name, value_str);
+            if (var.is_generator) {
+                scope.add_generator_value(var.front_name, value_str);
+            } else {
+                scope.add_local_value(var.front_name, value_str);
             }
         }
         resp.add_scope(scope);
     }
-
-    auto str = resp.str(log_enabled_);
-    send_message(str);
+    return resp;
 }
 
 void Debugger::send_monitor_values(MonitorRequest::MonitorType type) {
@@ -1183,6 +1447,11 @@ util::Options Debugger::get_options() {
     options.add_option("pause_at_posedge", &pause_at_posedge);
     options.add_option("perf_count", &perf_count_);
     options.add_option("use_signal_cache", &use_signal_cache_);
+    options.add_option("evaluation_threads", &evaluation_threads_);
+    options.add_option("idle_mode", &idle_mode_);
+    options.add_option("change_driven_evaluation", &change_driven_evaluation_);
+    options.add_option("shared_expression_evaluation", &shared_expression_evaluation_);
+    options.add_option("warm_up_handles", &warm_up_handles_);
     return options;
 }
 
@@ -1195,6 +1464,12 @@ void Debugger::set_vendor_initial_options() {
             // need to continue to simulation if client disconnected
             detach_after_disconnect_ = true;
         }
+        if (namespaces_.default_rtl()->is_mock()) {
+            // signal values in mock tests are changed outside the evaluation loop
+            use_signal_cache_ = false;
+            // mock tests drive clock callbacks directly
+            idle_mode_ = false;
+        }
     }
 }
 
@@ -1210,26 +1485,26 @@ bool Debugger::check_send_db_error(RequestType type, uint64_t conn_id) {
 }
 
 bool Debugger::should_trigger(DebugBreakPoint *bp) {
-    auto const &symbols = bp->trigger_symbols;
+    auto const &handles = bp->trigger_handles;
     // empty symbols means always trigger
-    if (symbols.empty()) return true;
-    bool should_trigger = false;
-    for (auto const &[symbol, handle] : symbols) {
-        // if we haven't seen the value yet, definitely trigger it
-        auto op_v = get_signal_value(bp->ns_id, handle);
-        if (!op_v) {
-            auto full_name = get_full_name(bp->ns_id, bp->instance_id, symbol);
+    if (handles.empty()) return true;
+    thread_local std::vector<std::optional<int64_t>> values;
+    values.resize(handles.size());
+    namespaces_[bp->ns_id]->rtl->get_values(handles, values);
+    // if we haven't seen the value yet, definitely trigger it
+    bool should_trigger = !bp->trigger_values_valid;
+    auto &last_values = bp->trigger_values;
+    for (auto i = 0u; i < handles.size(); i++) {
+        if (!values[i]) [[unlikely]] {
+            auto full_name = get_full_name(bp->ns_id, bp->instance_id, bp->trigger_names[i]);
             log_error(fmt::format("Unable to find signal {0} associated with breakpoint id {1}",
                                   full_name, bp->id));
             return true;
         }
-        auto value = *op_v;
-        if (bp->trigger_values.find(symbol) == bp->trigger_values.end() ||
-            bp->trigger_values.at(symbol) != value) {
-            should_trigger = true;
-        }
-        bp->trigger_values[symbol] = value;
+        should_trigger |= *values[i] != last_values[i];
+        last_values[i] = *values[i];
     }
+    bp->trigger_values_valid = true;
     return should_trigger;
 }
 
@@ -1257,37 +1532,62 @@ std::string Debugger::get_full_name(uint32_t ns_id, uint64_t instance_id,
 std::optional<int64_t> Debugger::get_signal_value(uint32_t ns_id, vpiHandle handle,
                                                   bool use_delayed) {
     // assume the name is already elaborated/mapped
-    if (use_signal_cache_) [[unlikely]] {
-        std::lock_guard guard(cached_signal_values_lock_);
-        if (cached_signal_values_.find(handle) != cached_signal_values_.end()) {
-            return cached_signal_values_.at(handle);
-        }
-    }
-    // need to actually get the value
-    std::optional<int64_t> value;
     if (use_delayed && delayed_variables_.find(handle) != delayed_variables_.end()) [[unlikely]] {
         return delayed_variables_.at(handle).value;
     }
 
-    value = namespaces_[ns_id]->rtl->get_value(handle);
+    // if signal cache is enabled, the RTL client serves the value from the cycle snapshot
+    auto value = namespaces_[ns_id]->rtl->get_value(handle);
 
     if (!value)
         log_info(fmt::format("Failed to obtain RTL value for handle id 0x{0}",
                              static_cast<void *>(handle)));
 
     if (value) {
-        if (use_signal_cache_) {
-            std::lock_guard guard(cached_signal_values_lock_);
-            cached_signal_values_.emplace(handle, *value);
-        }
-
         return *value;
     } else {
         return {};
     }
 }
 
-bool Debugger::eval_breakpoint(DebugBreakPoint *bp) {
+bool Debugger::eval_breakpoint(DebugBreakPoint *bp, bool shared_expression) {
+    auto const breakpoint_only = scheduler_->breakpoint_only();
+    auto const use_cached_result = scheduler_->use_cached_results();
+    const auto &bp_expr = breakpoint_only ? bp->expr : bp->enable_expr;
+    // conditions fully determined by static values don't need any simulator values
+    auto constant = bp_expr->correct() ? bp_expr->constant_value() : std::nullopt;
+    if (constant) return check_breakpoint_hit(bp, *constant);
+    // none of the inputs changed since the last evaluation
+    if (use_cached_result && bp->cached_result) {
+        return check_breakpoint_hit(bp, *bp->cached_result);
+    }
+    auto node = breakpoint_only ? bp->expr_node : bp->enable_expr_node;
+    if (shared_expression && node) {
+        // values computed by other breakpoints in the same batch are reused. fall back to the
+        // compiled expression if any signal can't be read, which also reports the error
+        auto &rtl = namespaces_[bp->ns_id]->rtl;
+        std::optional<int64_t> value;
+        {
+            perf::PerfCount count("eval shared expression", perf_count_);
+            auto read = [&rtl](vpiHandle handle) { return rtl->get_value(handle); };
+            value = bp->expr_graph->eval(*node, read);
+        }
+        if (value) [[likely]] {
+            if (use_cached_result && bp->change_driven) bp->cached_result = *value;
+            return check_breakpoint_hit(bp, *value);
+        }
+    }
+    if (!bind_breakpoint_values(bp)) return false;
+    long eval_result;
+    {
+        perf::PerfCount count("eval breakpoint", perf_count_);
+        eval_result = bp_expr->eval();
+    }
+    if (use_cached_result && bp->change_driven) bp->cached_result = eval_result;
+    return check_breakpoint_hit(bp, eval_result);
+}
+
+bool Debugger::bind_breakpoint_values(DebugBreakPoint *bp) {
     const auto &bp_expr = scheduler_->breakpoint_only() ? bp->expr : bp->enable_expr;
     if (!bp_expr->correct()) return false;
     bool res;
@@ -1298,95 +1598,276 @@ bool Debugger::eval_breakpoint(DebugBreakPoint *bp) {
     if (!res) [[unlikely]] {
         // something went wrong with the querying symbol
         log_error(fmt::format("Unable to evaluate breakpoint {0}", bp->id));
-    } else {
-        long eval_result;
-        {
-            perf::PerfCount count("eval breakpoint", perf_count_);
-            eval_result = bp_expr->eval();
-        }
+    }
+    return res;
+}
 
-        auto *ns = namespaces_[bp->ns_id];
-        auto trigger_result = should_trigger(bp);
-        bool data_bp = true;
-        bool enabled = eval_result && trigger_result;
-        if (bp->type == DebugBreakPoint::Type::data && enabled) {
-            auto [changed, _] = ns->monitor->var_changed(bp->watch_id);
-            data_bp = changed;
-        }
-        if (enabled && data_bp) {
-            // trigger a breakpoint!
-            return true;
-        }
+bool Debugger::check_breakpoint_hit(DebugBreakPoint *bp, int64_t eval_result) {
+    auto *ns = namespaces_[bp->ns_id];
+    auto trigger_result = should_trigger(bp);
+    bool data_bp = true;
+    bool enabled = eval_result && trigger_result;
+    if (bp->type == DebugBreakPoint::Type::data && enabled) {
+        auto [changed, _] = ns->monitor->var_changed(bp->watch_id);
+        data_bp = changed;
     }
-    return false;
+    // trigger a breakpoint if enabled
+    auto hit = enabled && data_bp;
+    if (hit && bp->hit_condition.kind != HitCountCondition::Kind::none) [[unlikely]] {
+        hit = bp->hit_condition.satisfied(++bp->hit_count);
+    }
+    return hit;
 }
 
 std::vector<bool> Debugger::eval_breakpoints(const std::vector<DebugBreakPoint *> &bps) {
-    std::vector<bool> hits(bps.size());
-    std::fill(hits.begin(), hits.end(), false);
-    // most of the time is on getting simulation values, so using many threads
-    // doesn't make any sense
-    const static auto processor_count = 2;
-    auto constexpr minimum_batch_size = 16;
-    auto const batch_min_size = processor_count * minimum_batch_size;
+    // each worker needs at least this many breakpoints to be worth waking up
+    auto constexpr minimum_batch_size = 16u;
     const static auto commercial =
         namespaces_.default_rtl()->is_vcs() || namespaces_.default_rtl()->is_xcelium();
-    if (bps.size() > batch_min_size && !commercial) {
-        // multi-threading for two threads
+    auto num_threads =
+        commercial ? 1u : static_cast<uint32_t>(std::max<int64_t>(evaluation_threads_, 1));
+    // adaptive cutoff: only share the work when every worker gets at least one full batch
+    auto workers = std::min<uint64_t>(num_threads, bps.size() / minimum_batch_size);
+    // use a byte per breakpoint so that workers don't race on the same word
+    std::vector<uint8_t> hits(bps.size(), 0);
+    // values memoized by the expression graph are only valid within the batch, since signals
+    // may be changed while the simulator is paused at a breakpoint hit
+    if (shared_expression_evaluation_) scheduler_->next_expression_epoch();
+    if (workers > 1) {
         perf::PerfCount perf_bp_threads("eval bp threads", perf_count_);
-        std::vector<std::thread> threads;
-        threads.reserve(processor_count);
-        auto batch_size = bps.size() / processor_count;
-        for (auto i = 0u; i < processor_count; i++) {
-            // lock-free map
-            auto start = i * batch_size;
-            auto end = (i == (processor_count - 1)) ? bps.size() : (i + 1) * batch_size;
-            threads.emplace_back(std::thread([start, end, &bps, &hits, this]() {
-                this->eval_breakpoint(bps, hits, start, end);
-            }));
-        }
-        for (auto &t : threads) t.join();
-
+        if (!evaluator_pool_ || evaluator_pool_->size() != num_threads) [[unlikely]] {
+            evaluator_pool_ = std::make_unique<ThreadPool>(num_threads);
+        }
+        // smaller batches than the even split so that idle workers have something to steal
+        auto batch_size = std::max<uint64_t>(minimum_batch_size, bps.size() / (num_threads * 4));
+        evaluator_pool_->parallel_for(bps.size(), batch_size,
+                                      [&bps, &hits, this](uint64_t start, uint64_t end) {
+                                          this->eval_breakpoint(bps, hits, start, end);
+                                      });
     } else {
-        // directly evaluate it in the current thread to avoid creating threads
-        // overhead
+        // directly evaluate it in the current thread to avoid synchronization overhead
         perf::PerfCount perf_bp_threads("eval bp single thread", perf_count_);
         this->eval_breakpoint(bps, hits, 0, bps.size());
     }
-    return hits;
-}
+    return {hits.begin(), hits.end()};
+}
+
+void Debugger::eval_breakpoint(const std::vector<DebugBreakPoint *> &bps,
+                               std::vector<uint8_t> &result, uint64_t start, uint64_t end) {
+    // breakpoints from the same source location across instances are placed next to each other
+    // by the scheduler and share the same compiled expression. evaluate them as lanes
+    auto constexpr minimum_lanes = 4u;
+    if (use_signal_cache_ && (end - start) > 1) {
+        perf::PerfCount count("prefetch_rtl_values", perf_count_);
+        prefetch_values(bps, start, end);
+    }
+    auto const breakpoint_only = scheduler_->breakpoint_only();
+    auto get_expr = [breakpoint_only](DebugBreakPoint *bp) {
+        return breakpoint_only ? bp->expr.get() : bp->enable_expr.get();
+    };
+    auto const use_cached_result = scheduler_->use_cached_results();
+    auto cached = [use_cached_result](DebugBreakPoint *bp) {
+        return use_cached_result && bp->cached_result;
+    };
+
+    thread_local std::vector<const DebugExpression *> lanes;
+    thread_local std::vector<int64_t> lane_results;
+
+    auto index = start;
+    while (index < end) {
+        auto *ref_expr = get_expr(bps[index]);
+        auto group_end = index + 1;
+        // constant conditions and cached results are cheaper to evaluate on their own
+        while (group_end < end && !ref_expr->constant_value() && !cached(bps[index]) &&
+               !cached(bps[group_end]) && get_expr(bps[group_end])->same_program(*ref_expr)) {
+            group_end++;
+        }
+        if (group_end - index < minimum_lanes) {
+            for (; index < group_end; index++) {
+                result[index] = eval_breakpoint(bps[index], shared_expression_evaluation_);
+            }
+            continue;
+        }
 
-void Debugger::eval_breakpoint(const std::vector<DebugBreakPoint *> &bps, std::vector<bool> &result,
-                               uint64_t start, uint64_t end) {
-    for (auto index = start; index < end; index++) {
-        bool r = eval_breakpoint(bps[index]);
-        result[index] = r;
+        lanes.clear();
+        for (auto i = index; i < group_end; i++) {
+            // breakpoints that fail to bind values are excluded
+            result[i] = bind_breakpoint_values(bps[i]);
+            if (result[i]) lanes.emplace_back(get_expr(bps[i]));
+        }
+        lane_results.resize(lanes.size());
+        {
+            perf::PerfCount count("eval breakpoint lanes", perf_count_);
+            ref_expr->eval(lanes, lane_results);
+        }
+        auto lane = 0u;
+        for (auto i = index; i < group_end; i++) {
+            if (!result[i]) continue;
+            auto *bp = bps[i];
+            auto eval_result = lane_results[lane++];
+            if (use_cached_result && bp->change_driven) bp->cached_result = eval_result;
+            result[i] = check_breakpoint_hit(bp, eval_result);
+        }
+        index = group_end;
     }
 }
 
-void Debugger::add_breakpoint(const BreakPoint &bp_info, const BreakPoint &db_bp) {
+void Debugger::add_breakpoint(const BreakPoint &bp_info, const BreakPoint &db_bp,
+                              const HitCountCondition &hit_condition,
+                              const TimeWindow &time_window) {
     scheduler_->add_breakpoint(bp_info, db_bp);
+    scheduler_->set_hit_condition(db_bp.id, DebugBreakPoint::Type::normal, hit_condition);
+    scheduler_->set_time_window(db_bp.id, DebugBreakPoint::Type::normal, time_window);
     process_delayed_breakpoint(db_bp.id);
 }
 
-void Debugger::start_breakpoint_evaluation() {
-    scheduler_->start_breakpoint_evaluation();
-    cached_signal_values_.clear();
+void Debugger::start_breakpoint_evaluation(std::optional<uint32_t> clock_domain) {
+    scheduler_->set_change_driven(change_driven_evaluation_);
+    scheduler_->start_breakpoint_evaluation(clock_domain);
+    // invalidate values from the last cycle
+    for (auto const &ns : namespaces_) {
+        ns->rtl->set_use_value_snapshot(use_signal_cache_);
+        ns->rtl->next_value_snapshot();
+    }
     update_delayed_values();
 }
 
+void Debugger::end_breakpoint_evaluation() {
+    // values are only stable within the cycle. once the simulator resumes, reads from the
+    // server thread have to go to the simulator again
+    for (auto const &ns : namespaces_) {
+        ns->rtl->set_use_value_snapshot(false);
+    }
+}
+
 void Debugger::add_cb_clocks() {
-    // TODO:
-    //     for now we assume all the designs share the same clock
-    //     this may not be the case
+    std::lock_guard guard(clock_cb_lock_);
+    register_clock_callbacks();
+}
+
+void Debugger::register_clock_callbacks() {
+    // each clock only evaluates breakpoints in its own domain. clocks are taken from the default
+    // namespace
     if (!namespaces_.empty() && namespaces_.default_rtl() &&
         !namespaces_.default_rtl()->is_verilator()) {
         // only trigger eval at the posedge clk
         auto *rtl = namespaces_.default_rtl();
-        auto clock_signals = util::get_clock_signals(rtl, db_.get());
-        bool r = rtl->monitor_signals(clock_signals, eval_hgdb_on_clk, this);
-        if (!r || clock_signals.empty()) log_error("Failed to register evaluation callback");
+        auto clock_signals =
+            scheduler_ ? scheduler_->clock_names() : util::get_clock_signals(rtl, db_.get());
+        bool r = !clock_signals.empty();
+        for (auto i = 0u; i < clock_signals.size() && r; i++) {
+            if (i == clock_domains_.size()) {
+                clock_domains_.emplace_back(std::make_unique<ClockDomainCallback>(
+                    ClockDomainCallback{.debugger = this, .clock_domain = i}));
+            }
+            r = rtl->monitor_signals({clock_signals[i]}, eval_hgdb_on_clk,
+                                     clock_domains_[i].get());
+        }
+        if (!r) {
+            log_error("Failed to register evaluation callback");
+            remove_clock_callbacks();
+        }
+        clock_cb_armed_ = r;
+    }
+}
+
+void Debugger::remove_clock_callbacks() {
+    auto *rtl = namespaces_.default_rtl();
+    auto const callback_names = rtl->callback_names();
+    for (auto const &callback_name : callback_names) {
+        if (callback_name.find("Monitor") != std::string::npos) {
+            log_info("Remove callback " + callback_name);
+            rtl->remove_call_back(callback_name);
+        }
+    }
+    clock_cb_armed_ = false;
+}
+
+bool Debugger::is_idle() {
+    if (!idle_mode_ || pause_at_posedge || !scheduler_ || !scheduler_->idle()) return false;
+    return std::all_of(namespaces_.begin(), namespaces_.end(),
+                       [](auto const &ns) { return ns->monitor->idle(); });
+}
+
+bool Debugger::outside_time_windows() {
+    if (!scheduler_ || !scheduler_->outside_time_windows()) return false;
+    // monitor values are still sent while any of them is inside its window
+    return std::all_of(namespaces_.begin(), namespaces_.end(),
+                       [](auto const &ns) { return !ns->monitor->active(); });
+}
+
+void Debugger::enter_idle() {
+    // called at the end of the evaluation loop, so removing the callback that is currently
+    // running is fine
+    std::lock_guard guard(clock_cb_lock_);
+    if (!clock_cb_armed_ || !is_idle()) [[likely]]
+        return;
+    {
+        perf::PerfCount perf("idle mode switch", perf_count_);
+        remove_clock_callbacks();
+        add_idle_wake_up();
+    }
+    idle_ = true;
+    exit_idle_requested_ = false;
+    idle_perf_ = std::make_unique<perf::PerfCount>("idle mode", perf_count_);
+    log_info("Nothing to evaluate. Clock callbacks removed");
+}
+
+void Debugger::exit_idle() {
+    // only called from the simulator thread
+    std::lock_guard guard(clock_cb_lock_);
+    if (!idle_) return;
+    if (!exit_idle_requested_.exchange(false) || is_idle()) {
+        // keep waiting for the next request
+        if (!idle_wake_up_cb_) add_idle_wake_up();
+        return;
+    }
+    {
+        perf::PerfCount perf("idle mode switch", perf_count_);
+        remove_idle_wake_up();
+        register_clock_callbacks();
+    }
+    idle_ = false;
+    // record the time spent in idle mode
+    idle_perf_ = nullptr;
+    log_info("Clock callbacks restored");
+}
+
+void Debugger::request_exit_idle() {
+    // called from the server thread. whether there is anything to evaluate is decided on the
+    // simulator thread
+    std::lock_guard guard(clock_cb_lock_);
+    if (idle_) exit_idle_requested_ = true;
+}
+
+void Debugger::add_idle_wake_up() {
+    // registered directly since a fired one-shot callback can't be looked up by name anymore
+    static s_vpi_time time{vpiSimTime};
+    s_cb_data cb_data{.reason = cbNextSimTime,
+                      .cb_rtn = on_idle_wake_up,
+                      .obj = nullptr,
+                      .time = &time,
+                      .value = nullptr,
+                      .user_data = reinterpret_cast<char *>(this)};
+    idle_wake_up_cb_ = namespaces_.default_rtl()->vpi()->vpi_register_cb(&cb_data);
+    if (!idle_wake_up_cb_) log_error("Failed to register idle wake up callback");
+}
+
+void Debugger::remove_idle_wake_up() {
+    if (!idle_wake_up_cb_) return;
+    namespaces_.default_rtl()->vpi()->vpi_remove_cb(idle_wake_up_cb_);
+    idle_wake_up_cb_ = nullptr;
+}
+
+PLI_INT32 Debugger::on_idle_wake_up(p_cb_data cb_data) {
+    auto *debugger = reinterpret_cast<Debugger *>(cb_data->user_data);
+    {
+        // the simulator releases one-shot callbacks once they fire
+        std::lock_guard guard(debugger->clock_cb_lock_);
+        debugger->idle_wake_up_cb_ = nullptr;
     }
+    debugger->exit_idle();
+    return 0;
 }
 
 void Debugger::setup_init_breakpoint_from_env() {
@@ -1450,24 +1931,74 @@ void Debugger::preload_db_from_env() {
 }
 
 bool Debugger::set_expr_values(uint32_t ns_id, DebugExpression *expr, uint32_t instance_id) {
-    auto const &symbol_handles = expr->get_resolved_symbol_handles();
-    const static std::unordered_map<std::string, int64_t> error = {};
-    for (auto const &[symbol_name, handle] : symbol_handles) {
-        if (symbol_name == util::instance_var_name) [[unlikely]] {
-            expr->set_value(symbol_name, instance_id);
-            continue;
-        } else if (symbol_name == util::time_var_name) [[unlikely]] {
-            expr->set_value(symbol_name,
-                            static_cast<int64_t>(namespaces_[ns_id]->rtl->get_simulation_time()));
+    using Kind = DebugExpression::SymbolBinding::Kind;
+    auto const &bindings = expr->get_resolved_symbol_handles();
+    auto &rtl = namespaces_[ns_id]->rtl;
+    // gather signal handles so that they can be read in one batch
+    thread_local std::vector<vpiHandle> handles;
+    thread_local std::vector<std::optional<int64_t>> values;
+    handles.clear();
+    for (auto const &binding : bindings) {
+        if (binding.kind == Kind::instance) [[unlikely]] {
+            expr->set_value(binding.slot, instance_id);
+        } else if (binding.kind == Kind::time) [[unlikely]] {
+            expr->set_value(binding.slot, static_cast<int64_t>(rtl->get_simulation_time()));
+        } else if (binding.kind == Kind::wide_signal) [[unlikely]] {
+            WideValue value;
+            if (!rtl->get_wide_value(binding.handle, value)) {
+                log_info(fmt::format("Failed to obtain RTL value for handle id 0x{0}",
+                                     static_cast<void *>(binding.handle)));
+                return false;
+            }
+            expr->set_value(binding.slot, value);
+        } else {
+            handles.emplace_back(binding.handle);
+        }
+    }
+    if (handles.empty()) return true;
+
+    values.resize(handles.size());
+    rtl->get_values(handles, values);
+    auto index = 0u;
+    for (auto const &binding : bindings) {
+        if (binding.kind != Kind::signal) [[unlikely]]
             continue;
+        auto const &v = values[index++];
+        if (!v) [[unlikely]] {
+            log_info(fmt::format("Failed to obtain RTL value for handle id 0x{0}",
+                                 static_cast<void *>(binding.handle)));
+            return false;
         }
-        auto v = get_signal_value(ns_id, handle);
-        if (!v) return false;
-        expr->set_value(symbol_name, *v);
+        expr->set_value(binding.slot, *v);
     }
     return true;
 }
 
+void Debugger::prefetch_values(const std::vector<DebugBreakPoint *> &bps, uint64_t start,
+                               uint64_t end) {
+    // read every signal needed by this batch in one go. values land in the cycle snapshot
+    // and are picked up by each breakpoint afterwards
+    std::unordered_map<uint32_t, std::vector<vpiHandle>> ns_handles;
+    auto const breakpoint_only = scheduler_->breakpoint_only();
+    auto const use_cached_result = scheduler_->use_cached_results();
+    for (auto i = start; i < end; i++) {
+        auto *bp = bps[i];
+        // cached results don't need any value
+        if (use_cached_result && bp->cached_result) continue;
+        auto const &bp_expr = breakpoint_only ? bp->expr : bp->enable_expr;
+        auto &handles = ns_handles[bp->ns_id];
+        for (auto const &binding : bp_expr->get_resolved_symbol_handles()) {
+            if (binding.kind == DebugExpression::SymbolBinding::Kind::signal) {
+                handles.emplace_back(binding.handle);
+            }
+        }
+    }
+    for (auto const &[ns_id, handles] : ns_handles) {
+        std::vector<std::optional<int64_t>> values(handles.size());
+        namespaces_[ns_id]->rtl->get_values(handles, values);
+    }
+}
+
 void Debugger::update_delayed_values() {
     // notice that we never delete them, which can be a future improvement
     if (delayed_variables_.empty()) return;
@@ -14,7 +14,12 @@ namespace util {
 class Options;
 }
 
+namespace perf {
+class PerfCount;
+}
+
 class DebuggerTestFriend;
+struct ClockDomainCallback;
 
 class Debugger {
 public:
@@ -25,7 +30,8 @@ public:
     void initialize_db(std::unique_ptr<SymbolTableProvider> db);
     void run();
     void stop();
-    void eval();
+    // evaluates breakpoints in the clock domain, or all of them if not specified
+    void eval(std::optional<uint32_t> clock_domain = std::nullopt);
 
     // some public information about the debugger
     [[maybe_unused]] [[nodiscard]] bool is_verilator();
@@ -35,6 +41,9 @@ public:
     static constexpr bool default_logging = false;
     static constexpr auto error_value_str = "ERROR";
     static constexpr auto debug_skip_db_load = "+DEBUG_NO_DB";
+    // most of the time is on getting simulation values, so using many threads
+    // usually doesn't make any sense
+    static constexpr int64_t default_evaluation_threads = 2;
 
     // status to expose to outside world
     [[nodiscard]] const std::atomic<bool> &is_running() const { return is_running_; }
@@ -70,9 +79,6 @@ private:
     // used for scheduler
     std::unique_ptr<Scheduler> scheduler_;
 
-    // reduce VPI traffic
-    std::unordered_map<vpiHandle, int64_t> cached_signal_values_;
-    std::mutex cached_signal_values_lock_;
     // reduce DB traffic and remapping computation
     std::unordered_map<uint64_t, std::string> cached_instance_name_;
     std::mutex cached_instance_name_lock_;
@@ -85,6 +91,29 @@ private:
     };
     std::unordered_map<vpiHandle, DelayedVariable> delayed_variables_;
 
+    // everything needed to report a breakpoint hit except for the values. built on the first
+    // hit of each (breakpoint, namespace) pair so that later hits only need to read values
+    struct BreakPointHitPlan {
+        struct Variable {
+            std::string front_name;
+            // for non-rtl variables this is the value to report
+            std::string rtl_name;
+            vpiHandle handle = nullptr;
+            // only needed for hex strings, so it's looked up on first use
+            std::optional<uint32_t> width;
+            bool is_rtl = false;
+            bool is_generator = false;
+            bool use_delay = false;
+            // index into handles, if the value is read from the simulator directly
+            uint32_t value_index = 0;
+        };
+        std::string instance_name;
+        std::vector<Variable> variables;
+        std::vector<vpiHandle> handles;
+    };
+    // keyed by breakpoint id and namespace id. only accessed from the simulator thread
+    std::unordered_map<uint64_t, BreakPointHitPlan> hit_plans_;
+
     // options
     // if in single thread mode, instances with the same fn/ln won't be evaluated as a batch
     bool single_thread_mode_ = false;
@@ -96,10 +125,56 @@ private:
     bool pause_at_posedge = false;
     // whether to collect perf. only useful when PERF_COUNT is turned on in cmake
     bool perf_count_ = false;
-    // whether to use signal value cache. by default, it is false
-    bool use_signal_cache_ = false;
+    // whether to use per-cycle signal value snapshot to reduce VPI traffic.
+    // on by default except for simulators that change values outside the evaluation loop
+    bool use_signal_cache_ = true;
+    // number of threads used to evaluate breakpoints, including the simulator thread
+    int64_t evaluation_threads_ = default_evaluation_threads;
+    // whether to remove clock callbacks when there is nothing to evaluate
+    bool idle_mode_ = true;
+    // whether to only re-evaluate breakpoints whose signals changed. this registers a value
+    // change callback on every signal used by breakpoint conditions, which only pays off when
+    // signal activity is sparse
+    bool change_driven_evaluation_ = false;
+    // whether to evaluate breakpoint conditions through the per-namespace expression graph, so
+    // that subexpressions shared by many breakpoints are computed once per batch
+    bool shared_expression_evaluation_ = true;
+    // whether to resolve every RTL name referenced by the symbol table when it is loaded, so
+    // that the first breakpoint hit doesn't pay for the handle lookups
+    bool warm_up_handles_ = false;
+
+    // idle mode. clock callbacks are removed once nothing needs to be evaluated at clock edges
+    // and added back as soon as something does. VPI calls are only allowed on the simulator
+    // thread, so client requests only flag the change and a one-shot callback at the next
+    // simulation time picks it up
+    std::mutex clock_cb_lock_;
+    bool clock_cb_armed_ = false;
+    bool idle_ = false;
+    std::atomic<bool> exit_idle_requested_ = false;
+    vpiHandle idle_wake_up_cb_ = nullptr;
+    // measures how long the simulation runs without any callback overhead
+    std::unique_ptr<perf::PerfCount> idle_perf_;
+    // user data for clock callbacks. entries are never removed since the simulator may still
+    // hold them
+    std::vector<std::unique_ptr<ClockDomainCallback>> clock_domains_;
+
+    // long-lived evaluator pool, created on first use
+    std::unique_ptr<ThreadPool> evaluator_pool_;
+
+    // set while the simulation thread is blocked on the runtime lock
+    std::atomic<bool> paused_ = false;
+    // find-when searches read the same provider as the simulation, which is not thread safe.
+    // they run on their own thread while the simulation is paused, and are cancelled as soon
+    // as it resumes
+    std::mutex find_when_lock_;
+    std::thread find_when_thread_;
+    std::atomic<bool> find_when_cancel_ = false;
 
     void detach();
+    // simulation side. blocks until the user resumes the simulation
+    void pause();
+    // needs find_when_lock_
+    void cancel_find_when();
 
     // message handler
     void on_message(const std::string &message, uint64_t conn_id);
@@ -114,12 +189,12 @@ private:
     bool get_test_plus_arg(const std::string &arg_name, bool check_env = false);
     bool get_logging();
     bool get_perf_count();
+    int64_t get_evaluation_threads();
+    void warm_up_handles();
     static void log_error(const std::string &msg);
     void log_info(const std::string &msg) const;
     bool has_cli_flag(const std::string &flag);
     [[nodiscard]] static std::string get_monitor_topic(uint64_t watch_id);
-    std::string get_value_str(uint32_t ns_id, const std::string &rtl_name, bool is_rtl,
-                              bool use_delay = false);
     std::optional<std::string> resolve_var_name(uint32_t ns_id, const std::string &var_name,
                                                 const std::optional<uint64_t> &instance_id,
                                                 const std::optional<uint64_t> &breakpoint_id);
@@ -139,9 +214,13 @@ private:
     void handle_error(const ErrorRequest &req, uint64_t conn_id);
     void handle_symbol(const SymbolRequest &req, uint64_t conn_id);
     void handle_data_breakpoint(const DataBreakpointRequest &req, uint64_t conn_id);
+    void handle_find_when(const FindWhenRequest &req, uint64_t conn_id);
+    void find_when(const FindWhenRequest &req, uint64_t conn_id);
 
     // send functions
     void send_breakpoint_hit(const std::vector<const DebugBreakPoint *> &bps);
+    BreakPointResponse get_breakpoint_hit_response(const std::vector<const DebugBreakPoint *> &bps);
+    BreakPointHitPlan &get_hit_plan(const DebugBreakPoint *bp);
     void send_monitor_values(MonitorRequest::MonitorType type);
 
     // options
@@ -154,12 +233,17 @@ private:
 
     // scheduler
     bool should_trigger(DebugBreakPoint *bp);
-    bool eval_breakpoint(DebugBreakPoint *bp);
-    void eval_breakpoint(const std::vector<DebugBreakPoint *> &bps, std::vector<bool> &result,
+    bool eval_breakpoint(DebugBreakPoint *bp, bool shared_expression = false);
+    bool bind_breakpoint_values(DebugBreakPoint *bp);
+    bool check_breakpoint_hit(DebugBreakPoint *bp, int64_t eval_result);
+    void eval_breakpoint(const std::vector<DebugBreakPoint *> &bps, std::vector<uint8_t> &result,
                          uint64_t start, uint64_t end);
     std::vector<bool> eval_breakpoints(const std::vector<DebugBreakPoint *> &bps);
-    void add_breakpoint(const BreakPoint &bp_info, const BreakPoint &db_bp);
-    void start_breakpoint_evaluation();
+    void add_breakpoint(const BreakPoint &bp_info, const BreakPoint &db_bp,
+                        const HitCountCondition &hit_condition = {},
+                        const TimeWindow &time_window = {});
+    void start_breakpoint_evaluation(std::optional<uint32_t> clock_domain);
+    void end_breakpoint_evaluation();
 
     // cached wrapper
     std::optional<int64_t> get_signal_value(uint32_t ns_id, vpiHandle handle,
@@ -169,6 +253,16 @@ private:
     // callbacks
     std::optional<std::function<void(hgdb::SymbolTableProvider &)>> on_client_connected_;
     void add_cb_clocks();
+    void register_clock_callbacks();
+    void remove_clock_callbacks();
+    bool is_idle();
+    bool outside_time_windows();
+    void enter_idle();
+    void exit_idle();
+    void request_exit_idle();
+    void add_idle_wake_up();
+    void remove_idle_wake_up();
+    static PLI_INT32 on_idle_wake_up(p_cb_data cb_data);
 
     // performance benchmark functions
     // only used to initialize the debugger to certain state, not for normal usage
@@ -176,6 +270,7 @@ private:
     void preload_db_from_env();
 
     bool set_expr_values(uint32_t ns_id, DebugExpression *expr, uint32_t instance_id);
+    void prefetch_values(const std::vector<DebugBreakPoint *> &bps, uint64_t start, uint64_t end);
 
     // update delayed values
     void update_delayed_values();
@@ -1,5 +1,8 @@
 #include "eval.hh"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
 #include <stack>
 #include <tao/pegtl.hpp>
 
@@ -105,7 +108,7 @@ struct grammar : seq<expression, eof> {};
 // parser logic
 class ParserStack {
 public:
-    explicit ParserStack(DebugExpression& debug) : debug_(debug) {}
+    explicit ParserStack(ParsedExpression& debug) : debug_(debug) {}
 
     [[nodiscard]] bool push(const std::string& op_str) {
         const static std::unordered_map<std::string, Operator> op_mapping = {
@@ -164,12 +167,12 @@ private:
     std::stack<Operator> ops_;
     std::stack<Expr*> exprs_;
 
-    DebugExpression& debug_;
+    ParsedExpression& debug_;
 };
 
 class ParserState {
 public:
-    explicit ParserState(DebugExpression& debug) : debug_(debug) {
+    explicit ParserState(ParsedExpression& debug) : debug_(debug) {
         stacks.emplace(ParserStack(debug_));
     }
 
@@ -200,7 +203,7 @@ private:
     // stack of stacks
     std::stack<ParserStack> stacks;
 
-    DebugExpression& debug_;
+    ParsedExpression& debug_;
 };
 
 template <typename Rule>
@@ -351,7 +354,7 @@ struct action<close_bracket> {
     }
 };
 
-Expr* parse(const std::string& value, DebugExpression& debug_expression) {
+Expr* parse(const std::string& value, ParsedExpression& debug_expression) {
     tao::pegtl::memory_input in(value, "");
     ParserState state(debug_expression);
     bool r = false;
@@ -426,49 +429,456 @@ ExpressionType Expr::eval() const {
 
 }  // namespace expr
 
-DebugExpression::DebugExpression(const std::string& expression) : expression_(expression) {
-    root_ = expr::parse(expression, *this);
+ParsedExpression::ParsedExpression(std::string expression) : expression(std::move(expression)) {
+    root = expr::parse(this->expression, *this);
+    compile();
 }
 
-expr::Expr* DebugExpression::add_expression(expr::Operator op) {
+std::shared_ptr<const ParsedExpression> ParsedExpression::get(const std::string& expression) {
+    // entries are weak so that one-off expressions, e.g. from evaluation requests, don't
+    // accumulate. expired entries are swept whenever the table doubles in size
+    static std::mutex cache_lock;
+    static std::unordered_map<std::string, std::weak_ptr<const ParsedExpression>> cache;
+    static uint64_t sweep_size = 64;
+    {
+        std::lock_guard guard(cache_lock);
+        auto pos = cache.find(expression);
+        if (pos != cache.end()) {
+            if (auto parsed = pos->second.lock()) return parsed;
+        }
+    }
+    // parse outside the lock. if another thread parses the same string concurrently, the
+    // first one to finish is kept
+    std::shared_ptr<const ParsedExpression> parsed = std::make_shared<ParsedExpression>(expression);
+    std::lock_guard guard(cache_lock);
+    auto& entry = cache[expression];
+    if (auto existing = entry.lock()) return existing;
+    entry = parsed;
+    if (cache.size() >= sweep_size) {
+        std::erase_if(cache, [](auto const& iter) { return iter.second.expired(); });
+        sweep_size = std::max<uint64_t>(64, cache.size() * 2);
+    }
+    return parsed;
+}
+
+expr::Expr* ParsedExpression::add_expression(expr::Operator op) {
     auto expr = std::make_unique<expr::Expr>(op);
     expressions_.emplace_back(std::move(expr));
     return expressions_.back().get();
 }
 
-expr::Symbol* DebugExpression::add_symbol(const std::string& name) {
-    if (symbols_str_.find(name) == symbols_str_.end()) {
-        symbols_str_.emplace(name);
+expr::Symbol* ParsedExpression::add_symbol(const std::string& name) {
+    if (symbols_str.find(name) == symbols_str.end()) {
+        symbols_str.emplace(name);
         expressions_.emplace_back(std::make_unique<expr::Symbol>(name));
         auto* ptr = reinterpret_cast<expr::Symbol*>(expressions_.back().get());
         symbols_.emplace(name, ptr);
+        // slots are handed out in order of appearance
+        auto slot = static_cast<uint32_t>(symbol_slots.size());
+        symbol_slots.emplace(name, slot);
     }
 
     return symbols_.at(name);
 }
 
+void ParsedExpression::compile() {
+    instructions.clear();
+    // symbol slots occupy the beginning of the register file
+    registers.assign(symbol_slots.size(), 0);
+    if (!root) return;
+
+    std::unordered_map<const expr::Expr*, uint32_t> node_regs;
+    for (auto const& [name, slot] : symbol_slots) {
+        node_regs.emplace(symbols_.at(name), slot);
+    }
+
+    auto lower = [&](auto&& self, const expr::Expr* node) -> uint32_t {
+        if (node_regs.find(node) != node_regs.end()) {
+            return node_regs.at(node);
+        }
+        uint32_t left, right;
+        if (node->op == expr::Operator::None) {
+            // constant
+            auto reg = static_cast<uint32_t>(registers.size());
+            registers.emplace_back(node->eval());
+            node_regs.emplace(node, reg);
+            return reg;
+        } else if (node->unary) {
+            left = right = self(self, node->unary);
+        } else {
+            left = self(self, node->left);
+            right = self(self, node->right);
+        }
+        auto dst = static_cast<uint32_t>(registers.size());
+        registers.emplace_back(0);
+        instructions.emplace_back(expr::Instruction{node->op, dst, left, right});
+        node_regs.emplace(node, dst);
+        return dst;
+    };
+
+    result_reg = lower(lower, root);
+}
+
+DebugExpression::DebugExpression(const std::string& expression)
+    : parsed_(ParsedExpression::get(expression)),
+      registers_(parsed_->registers),
+      correct_(parsed_->correct) {
+    fold();
+}
+
+namespace {
+inline ExpressionType apply(expr::Operator op, ExpressionType left, ExpressionType right) {
+    switch (op) {
+        case expr::Operator::None:
+        case expr::Operator::UAdd:
+            return left;
+        case expr::Operator::UMinus:
+            return -left;
+        case expr::Operator::Add:
+            return left + right;
+        case expr::Operator::Minus:
+            return left - right;
+        case expr::Operator::Multiply:
+            return left * right;
+        // both operands are always evaluated, so guard against the division by zero that
+        // short-circuit logic operators may have hidden before
+        case expr::Operator::Divide:
+            return right ? left / right : 0;
+        case expr::Operator::Mod:
+            return right ? left % right : 0;
+        case expr::Operator::Eq:
+            return left == right;
+        case expr::Operator::Neq:
+            return left != right;
+        case expr::Operator::Not:
+            return !left;
+        case expr::Operator::Invert:
+            return ~left;
+        case expr::Operator::And:
+            return left && right;
+        case expr::Operator::Xor:
+            return left ^ right;
+        case expr::Operator::Or:
+            return left || right;
+        case expr::Operator::BAnd:
+            return left & right;
+        case expr::Operator::BOr:
+            return left | right;
+        case expr::Operator::LT:
+            return left < right;
+        case expr::Operator::GT:
+            return left > right;
+        case expr::Operator::LE:
+            return left <= right;
+        case expr::Operator::GE:
+            return left >= right;
+        default:
+            return 0;
+    }
+}
+}  // namespace
+
+void DebugExpression::fold() {
+    program_.clear();
+    constant_ = std::nullopt;
+    if (!parsed_->root) return;
+    // literals and symbols with static values are known at this point. temporaries are known
+    // once the instruction producing them can be folded
+    std::vector<bool> known(registers_.size(), false);
+    auto const& instructions = parsed_->instructions;
+    auto const result_reg = parsed_->result_reg;
+    for (auto reg = num_slots(); reg < registers_.size(); reg++) known[reg] = true;
+    for (auto const& inst : instructions) known[inst.dst] = false;
+    for (auto const& name : static_values_) known[parsed_->symbol_slots.at(name)] = true;
+
+    std::vector<expr::Instruction> remaining;
+    for (auto const& inst : instructions) {
+        auto left_known = known[inst.left], right_known = known[inst.right];
+        auto left = registers_[inst.left], right = registers_[inst.right];
+        std::optional<ExpressionType> value;
+        if (left_known && right_known) {
+            value = apply(inst.op, left, right);
+        } else if (inst.op == expr::Operator::And &&
+                   ((left_known && !left) || (right_known && !right))) {
+            value = 0;
+        } else if (inst.op == expr::Operator::Or &&
+                   ((left_known && left) || (right_known && right))) {
+            value = 1;
+        }
+        if (value) {
+            // folded values stay in the register file, so the instruction is no longer needed
+            registers_[inst.dst] = *value;
+            known[inst.dst] = true;
+        } else {
+            remaining.emplace_back(inst);
+        }
+    }
+    if (known[result_reg]) {
+        constant_ = registers_[result_reg];
+        return;
+    }
+
+    // drop instructions whose results are no longer used, e.g. the other side of a folded
+    // logical and
+    std::vector<bool> used(registers_.size(), false);
+    used[result_reg] = true;
+    for (auto it = remaining.rbegin(); it != remaining.rend(); it++) {
+        if (!used[it->dst]) continue;
+        used[it->left] = used[it->right] = true;
+        program_.emplace_back(*it);
+    }
+    std::reverse(program_.begin(), program_.end());
+}
+
+namespace {
+inline void apply(expr::Operator op, const WideValue& left, const WideValue& right,
+                  WideValue& result) {
+    auto logical = [&result](bool value) { result = WideValue(value); };
+    auto bitwise = [&](auto func) {
+        for (auto i = 0u; i < WideValue::num_words; i++) {
+            result.words[i] = func(left.words[i], right.words[i]);
+        }
+    };
+    switch (op) {
+        case expr::Operator::None:
+        case expr::Operator::UAdd:
+            result = left;
+            break;
+        case expr::Operator::UMinus:
+            wide::negate(left, result);
+            break;
+        case expr::Operator::Add:
+            wide::add(left, right, result);
+            break;
+        case expr::Operator::Minus:
+            wide::sub(left, right, result);
+            break;
+        case expr::Operator::Multiply:
+            wide::mul(left, right, result);
+            break;
+        case expr::Operator::Divide:
+            wide::div_mod(left, right, &result, nullptr);
+            break;
+        case expr::Operator::Mod:
+            wide::div_mod(left, right, nullptr, &result);
+            break;
+        case expr::Operator::Eq:
+            logical(left == right);
+            break;
+        case expr::Operator::Neq:
+            logical(left != right);
+            break;
+        case expr::Operator::Not:
+            logical(left.zero());
+            break;
+        case expr::Operator::Invert:
+            bitwise([](uint64_t a, uint64_t) { return ~a; });
+            break;
+        case expr::Operator::And:
+            logical(!left.zero() && !right.zero());
+            break;
+        case expr::Operator::Xor:
+            bitwise([](uint64_t a, uint64_t b) { return a ^ b; });
+            break;
+        case expr::Operator::Or:
+            logical(!left.zero() || !right.zero());
+            break;
+        case expr::Operator::BAnd:
+            bitwise([](uint64_t a, uint64_t b) { return a & b; });
+            break;
+        case expr::Operator::BOr:
+            bitwise([](uint64_t a, uint64_t b) { return a | b; });
+            break;
+        case expr::Operator::LT:
+            logical(wide::compare(left, right) < 0);
+            break;
+        case expr::Operator::GT:
+            logical(wide::compare(left, right) > 0);
+            break;
+        case expr::Operator::LE:
+            logical(wide::compare(left, right) <= 0);
+            break;
+        case expr::Operator::GE:
+            logical(wide::compare(left, right) >= 0);
+            break;
+    }
+}
+}  // namespace
+
+WideValue DebugExpression::eval_wide() const {
+    if (!parsed_->root) [[unlikely]]
+        return {};
+    if (!wide()) return WideValue(eval());
+    auto* regs = wide_registers_.data();
+    for (auto reg = 0u; reg < registers_.size(); reg++) {
+        if (reg >= wide_slots_.size() || !wide_slots_[reg]) regs[reg] = WideValue(registers_[reg]);
+    }
+    // wide comparison and division are unsigned. narrow signals are read as signed integers,
+    // so they have to be zero extended from their declared width, otherwise a set msb turns
+    // into a huge value
+    for (auto const& binding : bindings_) {
+        if (binding.kind == SymbolBinding::Kind::signal ||
+            binding.kind == SymbolBinding::Kind::time) {
+            regs[binding.slot] = WideValue::zero_extend(registers_[binding.slot], binding.width);
+        }
+    }
+    for (auto const& inst : program_) {
+        apply(inst.op, regs[inst.left], regs[inst.right], regs[inst.dst]);
+    }
+    return regs[parsed_->result_reg];
+}
+
 int64_t DebugExpression::eval() const {
-    if (!root_) [[unlikely]]
+    if (!parsed_->root) [[unlikely]]
         return 0;
-    for (auto const& [name, value] : values_) {
-        symbols_.at(name)->set_value(value);
+    if (wide()) [[unlikely]] {
+        auto value = eval_wide().narrow();
+        return value ? *value : std::numeric_limits<int64_t>::max();
+    }
+    auto* regs = registers_.data();
+    for (auto const& inst : program_) {
+        regs[inst.dst] = apply(inst.op, regs[inst.left], regs[inst.right]);
+    }
+    return regs[parsed_->result_reg];
+}
+
+ExpressionType DebugExpression::eval(std::span<ExpressionType> registers) const {
+    if (!parsed_->root) [[unlikely]]
+        return 0;
+    auto* regs = registers.data();
+    for (auto const& inst : program_) {
+        regs[inst.dst] = apply(inst.op, regs[inst.left], regs[inst.right]);
+    }
+    return regs[parsed_->result_reg];
+}
+
+namespace {
+// element-wise kernels over value lanes. kept branch-free where possible so that they can be
+// auto-vectorized
+template <typename F>
+inline void lane_op(ExpressionType* dst, const ExpressionType* left, const ExpressionType* right,
+                    uint64_t size, F func) {
+    for (uint64_t i = 0; i < size; i++) {
+        dst[i] = func(left[i], right[i]);
     }
-    return root_->eval();
+}
+}  // namespace
+
+bool DebugExpression::same_program(const DebugExpression& other) const {
+    // static values may fold instances of the same source expression differently
+    // lanes only hold narrow registers
+    return parsed_->root && other.parsed_->root && !wide() && !other.wide() &&
+           expression() == other.expression() &&
+           registers_.size() == other.registers_.size() && program_ == other.program_;
+}
+
+void DebugExpression::eval(std::span<const DebugExpression* const> lanes,
+                           std::span<ExpressionType> results) const {
+    auto const size = static_cast<uint64_t>(lanes.size());
+    if (!parsed_->root || size == 0) [[unlikely]]
+        return;
+    // register r of lane l is stored at r * size + l
+    thread_local std::vector<ExpressionType> regs;
+    regs.resize(registers_.size() * size);
+    // load symbol slots and constants. temporaries are loaded too since constants are
+    // interleaved with them, but they are overwritten before being read
+    for (uint64_t reg = 0; reg < registers_.size(); reg++) {
+        auto* dst = regs.data() + reg * size;
+        for (uint64_t lane = 0; lane < size; lane++) {
+            dst[lane] = lanes[lane]->registers_[reg];
+        }
+    }
+
+    using expr::Operator;
+    for (auto const& inst : program_) {
+        auto* dst = regs.data() + inst.dst * size;
+        auto const* l = regs.data() + inst.left * size;
+        auto const* r = regs.data() + inst.right * size;
+        switch (inst.op) {
+            case Operator::None:
+            case Operator::UAdd:
+                lane_op(dst, l, r, size, [](auto a, auto) { return a; });
+                break;
+            case Operator::UMinus:
+                lane_op(dst, l, r, size, [](auto a, auto) { return -a; });
+                break;
+            case Operator::Add:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return a + b; });
+                break;
+            case Operator::Minus:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return a - b; });
+                break;
+            case Operator::Multiply:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return a * b; });
+                break;
+            case Operator::Divide:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return b ? a / b : 0; });
+                break;
+            case Operator::Mod:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return b ? a % b : 0; });
+                break;
+            case Operator::Eq:
+                lane_op(dst, l, r, size, [](auto a, auto b) -> ExpressionType { return a == b; });
+                break;
+            case Operator::Neq:
+                lane_op(dst, l, r, size, [](auto a, auto b) -> ExpressionType { return a != b; });
+                break;
+            case Operator::Not:
+                lane_op(dst, l, r, size, [](auto a, auto) -> ExpressionType { return a == 0; });
+                break;
+            case Operator::Invert:
+                lane_op(dst, l, r, size, [](auto a, auto) { return ~a; });
+                break;
+            case Operator::And:
+                lane_op(dst, l, r, size,
+                        [](auto a, auto b) -> ExpressionType { return (a != 0) & (b != 0); });
+                break;
+            case Operator::Xor:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return a ^ b; });
+                break;
+            case Operator::Or:
+                lane_op(dst, l, r, size,
+                        [](auto a, auto b) -> ExpressionType { return (a != 0) | (b != 0); });
+                break;
+            case Operator::BAnd:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return a & b; });
+                break;
+            case Operator::BOr:
+                lane_op(dst, l, r, size, [](auto a, auto b) { return a | b; });
+                break;
+            case Operator::LT:
+                lane_op(dst, l, r, size, [](auto a, auto b) -> ExpressionType { return a < b; });
+                break;
+            case Operator::GT:
+                lane_op(dst, l, r, size, [](auto a, auto b) -> ExpressionType { return a > b; });
+                break;
+            case Operator::LE:
+                lane_op(dst, l, r, size, [](auto a, auto b) -> ExpressionType { return a <= b; });
+                break;
+            case Operator::GE:
+                lane_op(dst, l, r, size, [](auto a, auto b) -> ExpressionType { return a >= b; });
+                break;
+        }
+    }
+
+    auto const* result = regs.data() + parsed_->result_reg * size;
+    std::copy(result, result + size, results.begin());
 }
 
 void DebugExpression::set_static_values(
     const std::unordered_map<std::string, int64_t>& static_values) {
     for (auto const& [name, value] : static_values) {
-        if (symbols_.find(name) != symbols_.end()) {
-            symbols_.at(name)->set_value(value);
+        if (auto slot = get_slot(name)) {
+            registers_[*slot] = value;
             static_values_.emplace(name);
         }
     }
+    fold();
 }
 
 std::unordered_set<std::string> DebugExpression::get_required_symbols() const {
     std::unordered_set<std::string> result;
-    for (auto const& name : symbols_str_) {
+    for (auto const& name : parsed_->symbols_str) {
         // only if we can't find the static value
         if (static_values_.find(name) == static_values_.end()) {
             result.emplace(name);
@@ -477,20 +887,44 @@ std::unordered_set<std::string> DebugExpression::get_required_symbols() const {
     return result;
 }
 
-void DebugExpression::set_resolved_symbol_handle(const std::string& name, vpiHandle handle) {
-    if (symbols_str_.find(name) != symbols_str_.end()) {
-        handles_.emplace(name, handle);
-        values_.emplace(name, 0);
+void DebugExpression::set_resolved_symbol_handle(const std::string& name, vpiHandle handle,
+                                                 SymbolBinding::Kind kind, uint32_t width) {
+    if (auto symbol_slot = get_slot(name)) {
+        auto slot = *symbol_slot;
+        auto pos = std::find_if(bindings_.begin(), bindings_.end(),
+                                [slot](auto const& binding) { return binding.slot == slot; });
+        if (pos != bindings_.end()) return;
+        bindings_.emplace_back(SymbolBinding{handle, slot, kind, width});
+        registers_[slot] = 0;
+        if (kind == SymbolBinding::Kind::wide_signal) {
+            if (wide_registers_.empty()) {
+                wide_registers_.resize(registers_.size());
+                wide_slots_.resize(registers_.size(), false);
+            }
+            wide_slots_[slot] = true;
+        }
     }
 }
 
 void DebugExpression::clear() {
-    handles_.clear();
-    values_.clear();
-    correct_ = true;
+    bindings_.clear();
+    wide_registers_.clear();
+    wide_slots_.clear();
+    correct_ = parsed_->correct;
+}
+
+std::optional<uint32_t> DebugExpression::get_slot(const std::string& name) const {
+    if (auto pos = parsed_->symbol_slots.find(name); pos != parsed_->symbol_slots.end()) {
+        return pos->second;
+    }
+    return std::nullopt;
 }
 
-void DebugExpression::set_value(const std::string& name, int64_t value) { values_[name] = value; }
+void DebugExpression::set_value(const std::string& name, int64_t value) {
+    auto slot = get_slot(name);
+    if (slot) [[likely]]
+        set_value(*slot, value);
+}
 
 void DebugExpression::set_values(const std::unordered_map<std::string, int64_t>& values) {
     for (auto const& [name, value] : values) {
@@ -498,4 +932,184 @@ void DebugExpression::set_values(const std::unordered_map<std::string, int64_t>&
     }
 }
 
-}  // namespace hgdb
\ No newline at end of file
+std::size_t ExpressionGraph::NodeKeyHash::operator()(const NodeKey& key) const {
+    auto hash = std::hash<uint64_t>()(static_cast<uint64_t>(key.kind) << 8u |
+                                      static_cast<uint64_t>(key.op));
+    auto combine = [&hash](uint64_t value) {
+        hash ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u);
+    };
+    combine(static_cast<uint64_t>(key.left) << 32u | key.right);
+    combine(reinterpret_cast<uint64_t>(key.handle));
+    combine(static_cast<uint64_t>(key.value));
+    return hash;
+}
+
+uint32_t ExpressionGraph::add_node(const NodeKey& key) {
+    auto pos = node_ids_.find(key);
+    if (pos != node_ids_.end()) return pos->second;
+    auto id = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back(key.kind, key.op, key.left, key.right, key.handle, key.value);
+    node_ids_.emplace(key, id);
+    return id;
+}
+
+std::optional<uint32_t> ExpressionGraph::intern(const DebugExpression& expr,
+                                                uint32_t instance_id) {
+    // wide values don't fit in the nodes
+    if (!expr.correct() || expr.wide()) return std::nullopt;
+    std::unique_lock guard(lock_);
+    if (expr.constant_) {
+        return add_node({NodeKind::constant, expr::Operator::None, 0, 0, nullptr, *expr.constant_});
+    }
+
+    // leaves are keyed by what they read, since the same symbol name refers to different
+    // signals in different instances
+    std::unordered_map<uint32_t, uint32_t> reg_nodes;
+    for (auto const& binding : expr.bindings_) {
+        NodeKey key{NodeKind::signal, expr::Operator::None, 0, 0, binding.handle, 0};
+        if (binding.kind == DebugExpression::SymbolBinding::Kind::time) {
+            key.kind = NodeKind::time;
+            key.handle = nullptr;
+        } else if (binding.kind == DebugExpression::SymbolBinding::Kind::instance) {
+            key.kind = NodeKind::constant;
+            key.handle = nullptr;
+            key.value = instance_id;
+        }
+        reg_nodes.emplace(binding.slot, add_node(key));
+    }
+    std::unordered_set<uint32_t> static_slots;
+    for (auto const& name : expr.static_values_) {
+        static_slots.emplace(*expr.get_slot(name));
+    }
+    auto const num_slots = expr.num_slots();
+    auto operand = [&](uint32_t reg) -> std::optional<uint32_t> {
+        if (reg_nodes.find(reg) != reg_nodes.end()) return reg_nodes.at(reg);
+        // symbols need either a binding or a static value
+        if (reg < num_slots && static_slots.find(reg) == static_slots.end()) return std::nullopt;
+        // literals and folded temporaries
+        auto id = add_node(
+            {NodeKind::constant, expr::Operator::None, 0, 0, nullptr, expr.registers_[reg]});
+        reg_nodes.emplace(reg, id);
+        return id;
+    };
+
+    for (auto const& inst : expr.program_) {
+        auto left = operand(inst.left), right = operand(inst.right);
+        if (!left || !right) return std::nullopt;
+        switch (inst.op) {
+            // normalize commutative operators so that a == b and b == a share the same node
+            case expr::Operator::Add:
+            case expr::Operator::Multiply:
+            case expr::Operator::Eq:
+            case expr::Operator::Neq:
+            case expr::Operator::And:
+            case expr::Operator::Xor:
+            case expr::Operator::Or:
+            case expr::Operator::BAnd:
+            case expr::Operator::BOr:
+                if (*left > *right) std::swap(left, right);
+                break;
+            default:
+                break;
+        }
+        reg_nodes[inst.dst] = add_node({NodeKind::op, inst.op, *left, *right, nullptr, 0});
+    }
+    return operand(expr.parsed_->result_reg);
+}
+
+void ExpressionGraph::next_epoch(uint64_t time) {
+    epoch_++;
+    time_ = time;
+}
+
+std::optional<ExpressionType> ExpressionGraph::eval(uint32_t node, const ValueReader& read) {
+    std::shared_lock guard(lock_);
+    return eval_node(node, read);
+}
+
+std::optional<ExpressionType> ExpressionGraph::eval_node(uint32_t id, const ValueReader& read) {
+    auto& node = nodes_[id];
+    // concurrent evaluations may compute the same node twice, which is harmless since they
+    // produce the same value
+    if (node.epoch.load(std::memory_order_acquire) == epoch_) {
+        return node.value.load(std::memory_order_relaxed);
+    }
+    std::optional<ExpressionType> value;
+    switch (node.kind) {
+        case NodeKind::constant:
+            return node.value.load(std::memory_order_relaxed);
+        case NodeKind::time:
+            value = static_cast<ExpressionType>(time_);
+            break;
+        case NodeKind::signal:
+            value = read(node.handle);
+            break;
+        case NodeKind::op: {
+            auto left = eval_node(node.left, read);
+            if (!left) return std::nullopt;
+            // operands don't have side effects, so logical operators can short-circuit
+            if (node.op == expr::Operator::And && !*left) {
+                value = 0;
+            } else if (node.op == expr::Operator::Or && *left) {
+                value = 1;
+            } else {
+                auto right = node.right == node.left ? left : eval_node(node.right, read);
+                if (!right) return std::nullopt;
+                value = apply(node.op, *left, *right);
+            }
+            break;
+        }
+    }
+    if (!value) return std::nullopt;
+    node.value.store(*value, std::memory_order_relaxed);
+    node.epoch.store(epoch_, std::memory_order_release);
+    return value;
+}
+
+ValueChangeSearch::ValueChangeSearch(const DebugExpression& expr,
+                                     std::vector<SlotValueChanges> changes, uint64_t start,
+                                     uint64_t end, bool include_start,
+                                     std::optional<uint32_t> time_slot)
+    : expr_(expr), changes_(std::move(changes)), time_slot_(time_slot) {
+    if (include_start) times_.emplace_back(start);
+    for (auto const& slot_changes : changes_) {
+        for (auto const& [time, value] : slot_changes.changes) {
+            if (time > start && time <= end) times_.emplace_back(time);
+        }
+    }
+    std::sort(times_.begin(), times_.end());
+    times_.erase(std::unique(times_.begin(), times_.end()), times_.end());
+}
+
+void ValueChangeSearch::search(uint64_t begin, uint64_t end, std::vector<uint64_t>& result) const {
+    end = std::min<uint64_t>(end, times_.size());
+    if (begin >= end) return;
+    using Change = std::pair<uint64_t, int64_t>;
+    auto registers = expr_.registers();
+    // position every signal at the value it holds at the first point. after that each point
+    // only needs to apply the changes between it and the previous one
+    std::vector<uint64_t> cursors(changes_.size());
+    for (auto i = 0u; i < changes_.size(); i++) {
+        auto const& changes = changes_[i].changes;
+        auto pos = std::upper_bound(
+            changes.begin(), changes.end(), times_[begin],
+            [](uint64_t time, const Change& change) { return time < change.first; });
+        cursors[i] = pos - changes.begin();
+        if (pos != changes.begin()) registers[changes_[i].slot] = std::prev(pos)->second;
+    }
+
+    for (auto index = begin; index < end; index++) {
+        auto const time = times_[index];
+        for (auto i = 0u; i < changes_.size(); i++) {
+            auto const& changes = changes_[i].changes;
+            auto& cursor = cursors[i];
+            while (cursor < changes.size() && changes[cursor].first <= time) {
+                registers[changes_[i].slot] = changes[cursor++].second;
+            }
+        }
+        if (time_slot_) registers[*time_slot_] = static_cast<ExpressionType>(time);
+        if (expr_.eval(registers)) result.emplace_back(time);
+    }
+}
+
+}  // namespace hgdb
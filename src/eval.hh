@@ -1,11 +1,20 @@
 #ifndef HGDB_EVAL_HH
 #define HGDB_EVAL_HH
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "wide.hh"
+
 namespace hgdb {
 
 using ExpressionType = int64_t;
@@ -56,58 +65,245 @@ public:
     explicit Symbol(std::string name) : Expr(Operator::None), name(std::move(name)) {}
     std::string name;
 };
+
+// flat instruction used by the compiled expression. operands and destination are indices into
+// the register file, where symbol slots come first, followed by constants and temporaries
+struct Instruction {
+    Operator op;
+    uint32_t dst;
+    uint32_t left;
+    uint32_t right;
+
+    bool operator==(const Instruction &) const = default;
+};
 }  // namespace expr
 
+class ExpressionGraph;
+
+// parse tree and compiled program of an expression string. parsing is the expensive part of
+// building an expression, and the result doesn't depend on where the expression is used, so
+// it is interned by string and shared by every DebugExpression built from the same source.
+// immutable once parsed
+struct ParsedExpression {
+    explicit ParsedExpression(std::string expression);
+    // returns the cached parse if the string is still in use by any expression
+    static std::shared_ptr<const ParsedExpression> get(const std::string &expression);
+
+    expr::Expr *add_expression(expr::Operator op);
+    expr::Symbol *add_symbol(const std::string &name);
+    void set_error() { correct = false; }
+
+    std::string expression;
+    // only for strings for fast access during evaluation
+    std::unordered_set<std::string> symbols_str;
+    // slots are assigned to symbols in order of appearance
+    std::unordered_map<std::string, uint32_t> symbol_slots;
+    // the parse tree is lowered once into a flat instruction list that evaluates against a
+    // register file. registers hold the initial values, i.e. symbol slots followed by literals
+    // and temporaries
+    std::vector<expr::Instruction> instructions;
+    std::vector<ExpressionType> registers;
+    uint32_t result_reg = 0;
+    expr::Expr *root = nullptr;
+    bool correct = true;
+
+private:
+    std::unordered_map<std::string, expr::Symbol *> symbols_;
+    std::vector<std::unique_ptr<expr::Expr>> expressions_;
+
+    void compile();
+};
+
 class DebugExpression {
 public:
     // unsigned int * is vpiHandle
     using vpiHandle = unsigned int *;
+    // resolved symbol, bound directly to its value slot
+    struct SymbolBinding {
+        // signals wider than 64 bits are bound to the wide register file
+        enum class Kind { signal, time, instance, wide_signal };
+        vpiHandle handle;
+        uint32_t slot;
+        Kind kind;
+        // declared signal width, 0 if unknown
+        uint32_t width = 0;
+    };
     explicit DebugExpression(const std::string &expression);
 
     // symbol table related functions
-    [[nodiscard]] const std::unordered_set<std::string> &symbols() const { return symbols_str_; }
-    [[nodiscard]] uint64_t size() const { return symbols_str_.size(); }
-    auto find(const std::string &value) const { return symbols_str_.find(value); }
-    auto end() const { return symbols_str_.end(); }
-    [[nodiscard]] bool empty() const { return symbols_str_.empty(); }
+    [[nodiscard]] const std::unordered_set<std::string> &symbols() const {
+        return parsed_->symbols_str;
+    }
+    [[nodiscard]] uint64_t size() const { return parsed_->symbols_str.size(); }
+    auto find(const std::string &value) const { return parsed_->symbols_str.find(value); }
+    auto end() const { return parsed_->symbols_str.end(); }
+    [[nodiscard]] bool empty() const { return parsed_->symbols_str.empty(); }
+    // wide expressions are narrowed to 64 bits, saturating values that don't fit
     [[nodiscard]] int64_t eval() const;
-    [[nodiscard]] bool correct() const { return correct_ && root_ != nullptr; }
+    [[nodiscard]] WideValue eval_wide() const;
+    // evaluates against a caller-owned copy of registers(), so that the same expression can be
+    // evaluated on different values concurrently. narrow expressions only
+    [[nodiscard]] ExpressionType eval(std::span<ExpressionType> registers) const;
+    [[nodiscard]] const std::vector<ExpressionType> &registers() const { return registers_; }
+    // true if any symbol is bound to a wide signal
+    [[nodiscard]] bool wide() const { return !wide_registers_.empty(); }
+    [[nodiscard]] bool correct() const { return correct_ && parsed_->root != nullptr; }
     void set_error() { correct_ = false; }
-    [[nodiscard]] const expr::Expr *root() const { return root_; }
-
-    expr::Expr *add_expression(expr::Operator op);
-    expr::Symbol *add_symbol(const std::string &name);
+    [[nodiscard]] const expr::Expr *root() const { return parsed_->root; }
 
     // compute the required symbols. used to speed up runtime evaluation to avoid
     // querying db
     [[nodiscard]] std::unordered_set<std::string> get_required_symbols() const;
     void set_static_values(const std::unordered_map<std::string, int64_t> &static_values);
-    void set_resolved_symbol_handle(const std::string &name, vpiHandle handle);
-    [[nodiscard]] auto const &get_resolved_symbol_handles() const { return handles_; }
+    void set_resolved_symbol_handle(const std::string &name, vpiHandle handle,
+                                    SymbolBinding::Kind kind = SymbolBinding::Kind::signal,
+                                    uint32_t width = 0);
+    [[nodiscard]] auto const &get_resolved_symbol_handles() const { return bindings_; }
     void clear();
 
     // no copy construction
     DebugExpression(const DebugExpression &) = delete;
 
-    [[nodiscard]] const std::string &expression() const { return expression_; }
+    [[nodiscard]] const std::string &expression() const { return parsed_->expression; }
 
     void set_value(const std::string &name, int64_t value);
     void set_values(const std::unordered_map<std::string, int64_t> &values);
 
+    // slot-based access. slots are assigned to symbols at parse time and stay stable for the
+    // lifetime of the expression, so the runtime can bind values without any string lookup
+    [[nodiscard]] std::optional<uint32_t> get_slot(const std::string &name) const;
+    void set_value(uint32_t slot, int64_t value) { registers_[slot] = value; }
+    // slot has to be bound as a wide signal
+    void set_value(uint32_t slot, const WideValue &value) { wide_registers_[slot] = value; }
+    [[nodiscard]] uint32_t num_slots() const {
+        return static_cast<uint32_t>(parsed_->symbol_slots.size());
+    }
+
+    // value of the expression if it is fully determined by literals and static values
+    [[nodiscard]] std::optional<ExpressionType> constant_value() const { return constant_; }
+
+    // batch evaluation. expressions compiled from the same source share the same program, so
+    // a group of them (e.g. the same breakpoint across many instances) can be evaluated in one
+    // pass where each expression is a lane. values are laid out as structure of arrays so that
+    // each instruction becomes a tight loop the compiler can vectorize
+    [[nodiscard]] bool same_program(const DebugExpression &other) const;
+    void eval(std::span<const DebugExpression *const> lanes,
+              std::span<ExpressionType> results) const;
+
 private:
-    std::string expression_;
-    // only for strings for fast access during evaluation
-    std::unordered_set<std::string> symbols_str_;
-    std::unordered_map<std::string, expr::Symbol *> symbols_;
+    std::shared_ptr<const ParsedExpression> parsed_;
     // used for holding static values
     std::unordered_set<std::string> static_values_;
-    std::unordered_map<std::string, int64_t> values_;
-    std::unordered_map<std::string, vpiHandle> handles_;
+    // dense list of resolved symbols, built once when the breakpoint is inserted
+    std::vector<SymbolBinding> bindings_;
 
-    std::vector<std::unique_ptr<expr::Expr>> expressions_;
+    // what remains of the parsed instructions after constant folding
+    std::vector<expr::Instruction> program_;
+    mutable std::vector<ExpressionType> registers_;
+    // only allocated once a wide signal is bound. narrow registers are extended into it before
+    // each wide evaluation: signals and time are zero extended, literals are sign extended
+    mutable std::vector<WideValue> wide_registers_;
+    std::vector<bool> wide_slots_;
+    std::optional<ExpressionType> constant_;
 
     bool correct_ = true;
-    expr::Expr *root_ = nullptr;
+
+    void fold();
+
+    friend class ExpressionGraph;
+};
+
+// hash-consed expression graph shared by all the breakpoints in a namespace. compiled
+// expressions are interned node by node, so a subexpression that appears in many conditions,
+// e.g. a scope guard, is stored once and evaluated at most once per cycle
+class ExpressionGraph {
+public:
+    using vpiHandle = DebugExpression::vpiHandle;
+    using ValueReader = std::function<std::optional<int64_t>(vpiHandle)>;
+
+    // returns the node computing the expression. expressions with unresolved symbols can't be
+    // interned. instance_id is the value of $instance
+    std::optional<uint32_t> intern(const DebugExpression &expr, uint32_t instance_id);
+    // invalidate values computed in the last cycle
+    void next_epoch(uint64_t time);
+    // signal values are pulled through the reader on demand. returns nullopt if any signal the
+    // node depends on can't be read
+    std::optional<ExpressionType> eval(uint32_t node, const ValueReader &read);
+
+    [[nodiscard]] uint64_t size() const { return nodes_.size(); }
+
+private:
+    enum class NodeKind { constant, signal, time, op };
+    struct Node {
+        NodeKind kind;
+        expr::Operator op;
+        uint32_t left;
+        uint32_t right;
+        vpiHandle handle;
+        // memoized value, valid if epoch matches the current one
+        std::atomic<ExpressionType> value;
+        std::atomic<uint64_t> epoch = 0;
+
+        Node(NodeKind kind, expr::Operator op, uint32_t left, uint32_t right, vpiHandle handle,
+             ExpressionType value)
+            : kind(kind), op(op), left(left), right(right), handle(handle), value(value) {}
+    };
+    struct NodeKey {
+        NodeKind kind;
+        expr::Operator op;
+        uint32_t left;
+        uint32_t right;
+        vpiHandle handle;
+        ExpressionType value;
+
+        bool operator==(const NodeKey &) const = default;
+    };
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey &key) const;
+    };
+
+    // nodes are never removed so that node ids stay valid. deque keeps existing nodes in place
+    std::deque<Node> nodes_;
+    std::unordered_map<NodeKey, uint32_t, NodeKeyHash> node_ids_;
+    // breakpoints can be inserted from the server thread while the simulator is evaluating
+    std::shared_mutex lock_;
+    // epoch 0 is never current so that fresh nodes are always computed
+    uint64_t epoch_ = 1;
+    uint64_t time_ = 0;
+
+    uint32_t add_node(const NodeKey &key);
+    std::optional<ExpressionType> eval_node(uint32_t node, const ValueReader &read);
+};
+
+// value changes of the signal bound to a symbol slot, sorted by time. the first change has to
+// be at or before the start of the search so that the initial value is known
+struct SlotValueChanges {
+    uint32_t slot;
+    std::vector<std::pair<uint64_t, int64_t>> changes;
+};
+
+// searches signal histories for the time points where an expression is true. the expression
+// can only change its value when one of its signals does, so only the merged change points are
+// evaluated. each point is evaluated independently, which allows the points to be split into
+// time ranges and searched in parallel
+class ValueChangeSearch {
+public:
+    // searches (start, end]. start itself is only included if include_start is set, which
+    // is not the case when continuing a previous search. time_slot is bound to $time
+    ValueChangeSearch(const DebugExpression &expr, std::vector<SlotValueChanges> changes,
+                      uint64_t start, uint64_t end, bool include_start,
+                      std::optional<uint32_t> time_slot);
+
+    [[nodiscard]] uint64_t size() const { return times_.size(); }
+    // appends the matching times among change points [begin, end) in ascending order.
+    // safe to call concurrently
+    void search(uint64_t begin, uint64_t end, std::vector<uint64_t> &result) const;
+
+private:
+    const DebugExpression &expr_;
+    std::vector<SlotValueChanges> changes_;
+    std::vector<uint64_t> times_;
+    std::optional<uint32_t> time_slot_;
 };
 
 }  // namespace hgdb
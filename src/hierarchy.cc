@@ -0,0 +1,105 @@
+#include "hierarchy.hh"
+
+#include <unordered_set>
+
+#include "rtl.hh"
+#include "util.hh"
+
+namespace hgdb {
+
+static std::string get_str(AVPIProvider *vpi, PLI_INT32 property, vpiHandle handle) {
+    // some simulators return null for unsupported properties
+    auto const *str = vpi->vpi_get_str(property, handle);
+    return str ? str : "";
+}
+
+const DesignInstance *DesignInstance::get_child(const std::string &child_name) const {
+    auto pos = child_index_.find(child_name);
+    return pos != child_index_.end() ? pos->second : nullptr;
+}
+
+const DesignSignal *DesignInstance::get_signal(const std::string &signal_name) const {
+    auto pos = signal_index_.find(signal_name);
+    return pos != signal_index_.end() ? &signals[pos->second] : nullptr;
+}
+
+DesignHierarchy::DesignHierarchy(AVPIProvider *vpi, std::span<const PLI_INT32> signal_types,
+                                 bool use_def_name) {
+    // BFS from the top, each module is visited exactly once
+    std::queue<DesignInstance *> queue;
+    queue.emplace(&root_);
+    while (!queue.empty()) {
+        auto *instance = queue.front();
+        queue.pop();
+        auto *handle_iter = vpi->vpi_iterate(vpiModule, instance->handle);
+        if (!handle_iter) continue;
+        vpiHandle child_handle;
+        while ((child_handle = vpi->vpi_scan(handle_iter)) != nullptr) {
+            auto child = std::make_unique<DesignInstance>();
+            child->name = get_str(vpi, vpiName, child_handle);
+            child->full_name = get_str(vpi, vpiFullName, child_handle);
+            if (use_def_name) child->def_name = get_str(vpi, vpiDefName, child_handle);
+            child->handle = child_handle;
+            child->parent = instance;
+            add_signals(vpi, *child, signal_types);
+            num_signals_ += child->signals.size();
+            num_instances_++;
+
+            queue.emplace(child.get());
+            instance->child_index_.emplace(child->name, child.get());
+            instance->children.emplace_back(std::move(child));
+        }
+    }
+}
+
+const DesignInstance *DesignHierarchy::find_instance(const std::string &full_name) const {
+    auto tokens = util::get_tokens(full_name, ".");
+    if (tokens.empty()) return nullptr;
+    const DesignInstance *instance = &root_;
+    for (auto const &token : tokens) {
+        instance = instance->get_child(token);
+        if (!instance) return nullptr;
+    }
+    return instance;
+}
+
+const DesignSignal *DesignHierarchy::find_signal(const std::string &full_name) const {
+    auto pos = full_name.find_last_of('.');
+    if (pos == std::string::npos) return nullptr;
+    auto const *instance = find_instance(full_name.substr(0, pos));
+    return instance ? instance->get_signal(full_name.substr(pos + 1)) : nullptr;
+}
+
+std::vector<DesignSignal> DesignHierarchy::scan_signals(AVPIProvider *vpi, vpiHandle module_handle,
+                                                        std::span<const PLI_INT32> signal_types) {
+    std::vector<DesignSignal> result;
+    std::unordered_set<std::string> names;
+    // a signal may be reported under more than one type
+    for (auto type : signal_types) {
+        auto *signal_iter = vpi->vpi_iterate(type, module_handle);
+        if (!signal_iter) continue;
+        vpiHandle signal_handle;
+        while ((signal_handle = vpi->vpi_scan(signal_iter)) != nullptr) {
+            auto name = get_str(vpi, vpiName, signal_handle);
+            if (names.find(name) != names.end()) continue;
+            auto width = vpi->vpi_get(vpiSize, signal_handle);
+            result.emplace_back(
+                DesignSignal{.name = name,
+                             .handle = signal_handle,
+                             .width = width > 0 ? static_cast<uint32_t>(width) : 0});
+            names.emplace(std::move(name));
+        }
+    }
+    return result;
+}
+
+void DesignHierarchy::add_signals(AVPIProvider *vpi, DesignInstance &instance,
+                                  std::span<const PLI_INT32> signal_types) {
+    instance.signals = scan_signals(vpi, instance.handle, signal_types);
+    instance.signal_index_.reserve(instance.signals.size());
+    for (auto i = 0u; i < instance.signals.size(); i++) {
+        instance.signal_index_.emplace(instance.signals[i].name, i);
+    }
+}
+
+}  // namespace hgdb
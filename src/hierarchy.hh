@@ -0,0 +1,95 @@
+#ifndef HGDB_HIERARCHY_HH
+#define HGDB_HIERARCHY_HH
+
+#include <memory>
+#include <queue>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "vpi_user.h"
+
+namespace hgdb {
+
+class AVPIProvider;
+
+struct DesignSignal {
+    std::string name;
+    vpiHandle handle = nullptr;
+    uint32_t width = 0;
+};
+
+struct DesignInstance {
+    // instance name, e.g. inst1
+    std::string name;
+    // hierarchical name as reported by the simulator, e.g. top.dut.inst1
+    std::string full_name;
+    // empty if the simulator doesn't support vpiDefName
+    std::string def_name;
+    vpiHandle handle = nullptr;
+    const DesignInstance *parent = nullptr;
+    // both in simulator order
+    std::vector<std::unique_ptr<DesignInstance>> children;
+    std::vector<DesignSignal> signals;
+
+    [[nodiscard]] const DesignInstance *get_child(const std::string &child_name) const;
+    [[nodiscard]] const DesignSignal *get_signal(const std::string &signal_name) const;
+
+private:
+    std::unordered_map<std::string, const DesignInstance *> child_index_;
+    std::unordered_map<std::string, uint32_t> signal_index_;
+
+    friend class DesignHierarchy;
+};
+
+// instance trie of the design, built with a single walk through the simulator hierarchy.
+// it is read-only once constructed, so it can be shared by every RTL client that talks to
+// the same simulator
+class DesignHierarchy {
+public:
+    // signal_types are the object types iterated for module signals, which differ among
+    // simulators. definition names are only queried if use_def_name is set
+    DesignHierarchy(AVPIProvider *vpi, std::span<const PLI_INT32> signal_types,
+                    bool use_def_name);
+
+    // the root is not an instance. its children are the top-level modules
+    [[nodiscard]] const DesignInstance &root() const { return root_; }
+    [[nodiscard]] const DesignInstance *find_instance(const std::string &full_name) const;
+    [[nodiscard]] const DesignSignal *find_signal(const std::string &full_name) const;
+    [[nodiscard]] uint64_t num_instances() const { return num_instances_; }
+    [[nodiscard]] uint64_t num_signals() const { return num_signals_; }
+
+    // breadth-first, which is the order instance mappings are reported in
+    template <typename F>
+    void visit(F &&func) const {
+        std::queue<const DesignInstance *> queue;
+        queue.emplace(&root_);
+        while (!queue.empty()) {
+            auto const *instance = queue.front();
+            queue.pop();
+            for (auto const &child : instance->children) {
+                func(*child);
+                queue.emplace(child.get());
+            }
+        }
+    }
+
+    // nets and variables of a single module, also used for instances that can't be reached
+    // from the root
+    static std::vector<DesignSignal> scan_signals(AVPIProvider *vpi, vpiHandle module_handle,
+                                                  std::span<const PLI_INT32> signal_types);
+
+private:
+    DesignInstance root_;
+    uint64_t num_instances_ = 0;
+    uint64_t num_signals_ = 0;
+
+    static void add_signals(AVPIProvider *vpi, DesignInstance &instance,
+                            std::span<const PLI_INT32> signal_types);
+};
+
+}  // namespace hgdb
+
+#endif  // HGDB_HIERARCHY_HH
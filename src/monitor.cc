@@ -1,5 +1,7 @@
 #include "monitor.hh"
 
+#include <algorithm>
+
 #include "rtl.hh"
 
 namespace hgdb {
@@ -53,6 +55,34 @@ void Monitor::set_monitor_variable_condition(uint64_t id, std::function<bool()>
     }
 }
 
+void Monitor::set_monitor_variable_window(uint64_t id, const TimeWindow& window) {
+    if (watched_variables_.find(id) != watched_variables_.end()) [[likely]] {
+        watched_variables_.at(id)->window = window;
+    }
+}
+
+bool Monitor::idle() const {
+    if (watched_variables_.empty()) return true;
+    if (!rtl_) return false;
+    auto time = rtl_->get_simulation_time();
+    return std::all_of(watched_variables_.begin(), watched_variables_.end(),
+                       [time](auto const& iter) {
+                           auto const& var = iter.second;
+                           return var->type == WatchType::data || var->window.closed(time);
+                       });
+}
+
+bool Monitor::active() const {
+    if (watched_variables_.empty()) return false;
+    if (!rtl_) return true;
+    auto time = rtl_->get_simulation_time();
+    return std::any_of(watched_variables_.begin(), watched_variables_.end(),
+                       [time](auto const& iter) {
+                           auto const& var = iter.second;
+                           return var->type != WatchType::data && var->window.contains(time);
+                       });
+}
+
 // NOLINTNEXTLINE
 std::optional<uint64_t> Monitor::is_monitored(vpiHandle handle, WatchType watch_type) const {
     for (auto const& [id, var] : watched_variables_) {
@@ -82,35 +112,53 @@ std::vector<std::pair<uint64_t, std::optional<int64_t>>> Monitor::get_watched_va
     // this is the maximum size
     result.reserve(watched_variables_.size());
 
+    // gather all the handles first so that values are read from the simulator in one call
+    std::vector<std::pair<uint64_t, WatchVariable*>> vars;
+    std::vector<vpiHandle> handles;
+    vars.reserve(watched_variables_.size());
+    handles.reserve(watched_variables_.size());
+    auto time = rtl_->get_simulation_time();
     for (auto& [watch_id, watch_var] : watched_variables_) {
-        if (watch_var->type != type) continue;
+        if (watch_var->type != type || !watch_var->window.contains(time)) continue;
+        auto* handle = watch_var->handle;
+        if ((type == WatchType::breakpoint || type == WatchType::clock_edge) &&
+            watch_var->enable_cond && !(*watch_var->enable_cond)()) {
+            // disabled. no need to query the simulator
+            handle = nullptr;
+        }
+        vars.emplace_back(watch_id, watch_var.get());
+        handles.emplace_back(handle);
+    }
+    std::vector<std::optional<int64_t>> values(handles.size());
+    rtl_->get_values(handles, values);
+
+    for (auto i = 0u; i < vars.size(); i++) {
+        auto [watch_id, watch_var] = vars[i];
+        auto const& value = values[i];
         switch (watch_var->type) {
             case WatchType::breakpoint:
             case WatchType::clock_edge: {
-                std::optional<int64_t> value;
-                if (!watch_var->enable_cond || (*watch_var->enable_cond)()) {
-                    value = rtl_->get_value(watch_var->handle);
+                if (handles[i] == watch_var->handle) {
+                    result.emplace_back(std::make_pair(watch_id, value));
                 } else {
-                    value = watch_var->get_value();
+                    result.emplace_back(std::make_pair(watch_id, watch_var->get_value()));
                 }
-                result.emplace_back(std::make_pair(watch_id, value));
                 break;
             }
             case WatchType::data:
             case WatchType::changed: {
                 // only if values are changed
-                auto [changed, value] = var_changed(watch_id);
+                auto [changed, new_value] = update_changed(*watch_var, value);
                 if (changed) {
-                    result.emplace_back(std::make_pair(watch_id, value));
+                    result.emplace_back(std::make_pair(watch_id, new_value));
                 }
                 break;
             }
             case WatchType::delay_clock_edge: {
                 // we assume this will be called every clock cycle
-                auto new_value = rtl_->get_value(watch_var->handle);
                 // we use the old value
                 auto old_value = *watch_var->get_value();
-                watch_var->set_value(new_value);
+                watch_var->set_value(value);
                 result.emplace_back(std::make_pair(watch_id, old_value));
             }
         }
@@ -136,12 +184,17 @@ std::pair<bool, std::optional<int64_t>> Monitor::var_changed(uint64_t id) {
     }
     auto& watch_var = watched_variables_.at(id);
     auto value = rtl_->get_value(watch_var->handle);
+    return update_changed(*watch_var, value);
+}
+
+std::pair<bool, std::optional<int64_t>> Monitor::update_changed(WatchVariable& watch_var,
+                                                                std::optional<int64_t> value) {
     if (value) {
         bool changed = false;
-        auto const& watch_var_value = watch_var->get_value();
+        auto const& watch_var_value = watch_var.get_value();
         if (!watch_var_value.has_value() || watch_var_value.value() != *value) changed = true;
         if (changed) {
-            watch_var->set_value(value);
+            watch_var.set_value(value);
         }
         return {changed, value};
     }
@@ -27,6 +27,7 @@ public:
     [[nodiscard]] std::optional<uint64_t> is_monitored(vpiHandle handle,
                                                        WatchType watch_type) const;
     void set_monitor_variable_condition(uint64_t id, std::function<bool()> cond);
+    void set_monitor_variable_window(uint64_t id, const TimeWindow& window);
     [[nodiscard]] std::shared_ptr<std::optional<int64_t>> get_watched_value_ptr(
         const std::unordered_set<std::string>& var_names, WatchType type) const;
     // called every cycle
@@ -34,6 +35,11 @@ public:
     std::vector<std::pair<uint64_t, std::optional<int64_t>>> get_watched_values(WatchType type);
 
     [[nodiscard]] bool empty() const { return watched_variables_.empty(); }
+    // true if no watch variable will report values from now on. data watch variables are
+    // driven by their data breakpoints and therefore not considered
+    [[nodiscard]] bool idle() const;
+    // true if any watch variable reports values at the current simulation time
+    [[nodiscard]] bool active() const;
     [[nodiscard]] uint64_t num_watches(const std::string& name, WatchType type) const;
 
     // notice that each call will change the internal stored value
@@ -50,6 +56,8 @@ private:
 
         // enable condition associated with the watch variable. by default, it's always enabled
         std::optional<std::function<bool()>> enable_cond;
+        // values are only reported inside the time window
+        TimeWindow window;
 
         [[nodiscard]] virtual std::optional<int64_t> get_value() const;
         virtual void set_value(std::optional<int64_t> v);
@@ -81,6 +89,8 @@ private:
     std::unordered_map<uint64_t, std::unique_ptr<WatchVariable>> watched_variables_;
 
     uint32_t add_watch_var(std::unique_ptr<WatchVariable> w);
+    static std::pair<bool, std::optional<int64_t>> update_changed(WatchVariable &watch_var,
+                                                                  std::optional<int64_t> value);
 };
 
 }  // namespace hgdb
@@ -33,8 +33,11 @@ void DebuggerNamespaceManager::compute_instance_mapping(SymbolTableProvider *db)
     auto mapping =
         default_rtl()->compute_instance_mapping(instances, default_rtl()->vpi()->has_defname());
 
+    // every namespace sees the same design, so the hierarchy is only walked once
+    auto hierarchy = default_rtl()->design_hierarchy();
     for (auto i = 1u; i < mapping.size(); i++) {
-        add_namespace(default_rtl()->vpi());
+        auto *ns = add_namespace(default_rtl()->vpi());
+        ns->rtl->set_design_hierarchy(hierarchy);
     }
 
     for (auto i = 0u; i < mapping.size(); i++) {
@@ -2,6 +2,8 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <cctype>
 #include <utility>
 
 #include "rapidjson/document.h"
@@ -38,6 +40,9 @@ namespace hgdb {
  *     action: [required] - string: "add" or "remove"
  *     column_num: [optional] - uint64_t
  *     condition: [optional] - string
+ *     hit_count: [optional] - string: ">= N", "== N" or "% N"
+ *     start_time: [optional] - uint64_t
+ *     end_time: [optional] - uint64_t
  *
  * Breakpoint ID Request
  * type: breakpoint-id
@@ -45,6 +50,9 @@ namespace hgdb {
  *     id: [required] - uint64_t
  *     action: [required] - string: "add" or "remove"
  *     condition: [optional] - string
+ *     hit_count: [optional] - string: ">= N", "== N" or "% N"
+ *     start_time: [optional] - uint64_t
+ *     end_time: [optional] - uint64_t
  *
  *
  * Connection Request
@@ -99,6 +107,8 @@ namespace hgdb {
  *      breakpoint_id: [optional] - uint64_t
  *      track_id: [required for remove] - uint64_t
  *      namespace_id: [optional] - uint64_t
+ *      start_time: [optional] - uint64_t
+ *      end_time: [optional] - uint64_t
  * # notice that add request will get track_id in the generic response. clients are required
  * # to parse the value and use that as tracking id
  *
@@ -119,6 +129,20 @@ namespace hgdb {
  *     var_name: [required for add] - string
  *     breakpoint: [required for add] - uint64_t
  *     condition: [optional] - string
+ *     start_time: [optional] - uint64_t
+ *     end_time: [optional] - uint64_t
+ *
+ * Find When Request
+ * type: find-when
+ * payload:
+ *     expression: [required] - string
+ *     breakpoint_id: [optional] - uint32_t
+ *     instance_id: [optional] - uint32_t
+ *     namespace_id: [optional] - uint32_t
+ *     start_time: [optional] - uint64_t
+ *     end_time: [optional] - uint64_t
+ *     limit: [optional] - uint64_t
+ * # only available when the simulator can provide signal history, e.g. replay
  *
  * Generic Response
  * type: generic
@@ -174,6 +198,12 @@ namespace hgdb {
  *         track_id: uint64_t
  *         value: uint64_t
  *
+ * Find When Response
+ * type: find-when
+ * payload:
+ *     times: Array<uint64_t> - times where the expression is true, in ascending order
+ *     done: bool - false if more responses will follow
+ *
  */
 
 template <typename T>
@@ -226,6 +256,61 @@ static std::optional<T> get_member(K &document, const char *member_name, std::st
     return std::nullopt;
 }
 
+template <typename K>
+static bool parse_hit_count(K &document, HitCountCondition &hit_count, std::string &error) {
+    if (!check_member(document, "hit_count", error, false)) return true;
+    auto str = get_member<std::string>(document, "hit_count", error);
+    if (!str) return false;
+    auto condition = HitCountCondition::parse(*str);
+    if (!condition) {
+        error = fmt::format("Invalid hit count condition {0}", *str);
+        return false;
+    }
+    hit_count = *condition;
+    return true;
+}
+
+template <typename K>
+static bool parse_time_window(K &document, TimeWindow &window, std::string &error) {
+    if (check_member(document, "start_time", error, false)) {
+        auto start = get_member<uint64_t>(document, "start_time", error);
+        if (!start) return false;
+        window.start = *start;
+    }
+    if (check_member(document, "end_time", error, false)) {
+        auto end = get_member<uint64_t>(document, "end_time", error);
+        if (!end) return false;
+        window.end = *end;
+    }
+    if (window.start > window.end) {
+        error = fmt::format("Invalid time window [{0}, {1}]", window.start, window.end);
+        return false;
+    }
+    return true;
+}
+
+std::optional<HitCountCondition> HitCountCondition::parse(const std::string &str) {
+    using Kind = HitCountCondition::Kind;
+    static const std::pair<std::string_view, Kind> operators[] = {
+        {">=", Kind::at_least}, {"==", Kind::equal}, {"%", Kind::every}, {"every", Kind::every}};
+    auto is_digit = [](unsigned char c) { return std::isdigit(c); };
+    std::string value;
+    for (unsigned char c : str) {
+        if (!std::isspace(c)) value.push_back(static_cast<char>(c));
+    }
+    for (auto const &[op, kind] : operators) {
+        if (!value.starts_with(op)) continue;
+        auto count_str = value.substr(op.size());
+        if (count_str.empty() || !std::all_of(count_str.begin(), count_str.end(), is_digit)) {
+            return std::nullopt;
+        }
+        auto count = util::stoul(count_str);
+        if (!count || *count == 0) return std::nullopt;
+        return HitCountCondition{.kind = kind, .count = *count};
+    }
+    return std::nullopt;
+}
+
 std::string to_string(RequestType type) noexcept {
     switch (type) {
         case RequestType::error:
@@ -256,6 +341,8 @@ std::string to_string(RequestType type) noexcept {
             return "symbol";
         case RequestType::data_breakpoint:
             return "data-breakpoint";
+        case RequestType::find_when:
+            return "find-when";
     }
     return "error";
 }
@@ -665,6 +752,27 @@ std::string EvaluationResponse::str(bool pretty_print) const {
     return to_string(document, pretty_print);
 }
 
+FindWhenResponse::FindWhenResponse(std::vector<uint64_t> times, bool done)
+    : times_(std::move(times)), done_(done) {}
+
+std::string FindWhenResponse::str(bool pretty_print) const {
+    using namespace rapidjson;
+    Document document(rapidjson::kObjectType);  // NOLINT
+    auto &allocator = document.GetAllocator();
+    set_response_header(document, this);
+    set_status(document, status_);
+
+    Value payload(kObjectType);
+    Value times(kArrayType);
+    set_member(times, allocator, times_);
+    payload.AddMember("times", times.Move(), allocator);
+    set_member(payload, allocator, "done", done_);
+
+    set_member(document, "payload", payload);
+
+    return to_string(document, pretty_print);
+}
+
 MonitorResponse::MonitorResponse(uint64_t track_id, uint64_t namespace_id, std::string value)
     : track_id_(track_id), namespace_id_(namespace_id), value_(std::move(value)) {}
 
@@ -730,6 +838,8 @@ std::unique_ptr<Request> Request::parse_request(const std::string &str) {
         result = std::make_unique<SetValueRequest>();
     } else if (type_str == "data-breakpoint") {
         result = std::make_unique<DataBreakpointRequest>();
+    } else if (type_str == "find-when") {
+        result = std::make_unique<FindWhenRequest>();
     } else {
         result = std::make_unique<ErrorRequest>("Unknown request");
     }
@@ -798,6 +908,10 @@ void BreakPointRequest::parse_payload(const std::string &payload) {
     else
         bp_.column_num = 0;
     if (condition) bp_.condition = *condition;
+    if (!parse_hit_count(document, hit_count_, error_reason_) ||
+        !parse_time_window(document, time_window_, error_reason_)) {
+        status_code_ = status_code::error;
+    }
 }
 
 void BreakPointIDRequest::parse_payload(const std::string &payload) {
@@ -827,6 +941,10 @@ void BreakPointIDRequest::parse_payload(const std::string &payload) {
 
     auto condition = get_member<std::string>(document, "condition", error_reason_, false);
     if (condition) bp_.condition = *condition;
+    if (!parse_hit_count(document, hit_count_, error_reason_) ||
+        !parse_time_window(document, time_window_, error_reason_)) {
+        status_code_ = status_code::error;
+    }
 }
 
 ErrorRequest::ErrorRequest(std::string reason) {
@@ -1048,6 +1166,10 @@ void MonitorRequest::parse_payload(const std::string &payload) {
 
         instance_id_ = get_member<uint64_t>(document, "instance_id", error_reason_, false);
         breakpoint_id_ = get_member<uint64_t>(document, "breakpoint_id", error_reason_, false);
+        if (!parse_time_window(document, time_window_, error_reason_)) {
+            status_code_ = status_code::error;
+            return;
+        }
     } else {
         // only track_id is required
         auto track_id = get_member<uint64_t>(document, "track_id", error_reason_);
@@ -1320,6 +1442,37 @@ void DataBreakpointRequest::parse_payload(const std::string &payload) {
         if (condition_opt) {
             condition_ = *condition_opt;
         }
+        if (!parse_time_window(document, time_window_, error_reason_)) {
+            status_code_ = status_code::error;
+        }
+    }
+}
+
+void FindWhenRequest::parse_payload(const std::string &payload) {
+    using namespace rapidjson;
+    Document document;
+    document.Parse(payload.c_str());
+    if (!check_json(document, status_code_, error_reason_)) return;
+
+    breakpoint_id_ = get_member<uint32_t>(document, "breakpoint_id", error_reason_, false);
+    instance_id_ = get_member<uint32_t>(document, "instance_id", error_reason_, false);
+    namespace_id_ = get_member<uint64_t>(document, "namespace_id", error_reason_, false);
+    auto expression = get_member<std::string>(document, "expression", error_reason_);
+    if (!expression) {
+        status_code_ = status_code::error;
+        return;
+    }
+    expression_ = *expression;
+
+    if (check_member(document, "limit", error_reason_, false)) {
+        limit_ = get_member<uint64_t>(document, "limit", error_reason_);
+        if (!limit_) {
+            status_code_ = status_code::error;
+            return;
+        }
+    }
+    if (!parse_time_window(document, time_window_, error_reason_)) {
+        status_code_ = status_code::error;
     }
 }
 
@@ -3,6 +3,8 @@
 
 #include <fmt/format.h>
 
+#include <limits>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -26,7 +28,8 @@ enum class RequestType {
     monitor,
     set_value,
     symbol,
-    data_breakpoint
+    data_breakpoint,
+    find_when
 };
 
 [[nodiscard]] std::string to_string(RequestType type) noexcept;
@@ -157,6 +160,45 @@ public:
     [[nodiscard]] RequestType type() const override { return RequestType::error; }
 };
 
+// only hits that satisfy the hit count condition pause the simulation. hits are counted
+// after the breakpoint condition is evaluated to true
+struct HitCountCondition {
+    enum class Kind { none, at_least, equal, every };
+    Kind kind = Kind::none;
+    uint64_t count = 0;
+
+    [[nodiscard]] bool satisfied(uint64_t hits) const {
+        switch (kind) {
+            case Kind::at_least:
+                return hits >= count;
+            case Kind::equal:
+                return hits == count;
+            case Kind::every:
+                return hits % count == 0;
+            case Kind::none:
+            default:
+                return true;
+        }
+    }
+
+    // accepted formats are ">= N", "== N" and "% N" (or "every N"), where N > 0
+    static std::optional<HitCountCondition> parse(const std::string &str);
+};
+
+// simulation time window [start, end] in which a breakpoint or monitor is active. both ends are
+// inclusive. the default window covers the entire simulation
+struct TimeWindow {
+    uint64_t start = 0;
+    uint64_t end = std::numeric_limits<uint64_t>::max();
+
+    [[nodiscard]] bool contains(uint64_t time) const { return time >= start && time <= end; }
+    // once the window is closed it will never open again unless the simulation goes backward
+    [[nodiscard]] bool closed(uint64_t time) const { return time > end; }
+    [[nodiscard]] bool bounded() const {
+        return start != 0 || end != std::numeric_limits<uint64_t>::max();
+    }
+};
+
 class BreakPointRequest : public Request {
 public:
     enum class action { add, remove };
@@ -166,11 +208,15 @@ public:
     void parse_payload(const std::string &payload) override;
     [[nodiscard]] const auto &breakpoint() const { return bp_; }
     [[nodiscard]] auto bp_action() const { return bp_action_; }
+    [[nodiscard]] const auto &hit_count() const { return hit_count_; }
+    [[nodiscard]] const auto &time_window() const { return time_window_; }
     [[nodiscard]] RequestType type() const override { return RequestType::breakpoint; }
 
 protected:
     BreakPoint bp_;
     action bp_action_ = action::add;
+    HitCountCondition hit_count_;
+    TimeWindow time_window_;
 };
 
 class BreakPointIDRequest : public BreakPointRequest {
@@ -304,6 +350,7 @@ public:
     [[nodiscard]] const std::optional<uint64_t> &instance_id() const { return instance_id_; }
     [[nodiscard]] uint64_t track_id() const { return track_id_; }
     [[nodiscard]] std::optional<uint64_t> namespace_id() const { return namespace_id_; }
+    [[nodiscard]] const TimeWindow &time_window() const { return time_window_; }
 
 private:
     ActionType action_type_ = ActionType::add;
@@ -313,6 +360,7 @@ private:
     std::optional<uint64_t> instance_id_;
     uint64_t track_id_ = 0;
     std::optional<uint64_t> namespace_id_;
+    TimeWindow time_window_;
 };
 
 class SetValueRequest : public Request {
@@ -385,6 +433,7 @@ public:
     [[nodiscard]] const std::string &condition() const { return condition_; }
     [[nodiscard]] Action action() const { return action_; }
     [[nodiscard]] std::optional<uint64_t> namespace_id() const { return namespace_id_; }
+    [[nodiscard]] const TimeWindow &time_window() const { return time_window_; }
 
 private:
     uint64_t breakpoint_id_ = 0;
@@ -392,6 +441,30 @@ private:
     std::string condition_;
     Action action_ = Action::add;
     std::optional<uint64_t> namespace_id_;
+    TimeWindow time_window_;
+};
+
+class FindWhenRequest : public Request {
+public:
+    FindWhenRequest() = default;
+    void parse_payload(const std::string &payload) override;
+    [[nodiscard]] RequestType type() const override { return RequestType::find_when; }
+
+    [[nodiscard]] std::optional<uint32_t> instance_id() const { return instance_id_; }
+    [[nodiscard]] std::optional<uint32_t> breakpoint_id() const { return breakpoint_id_; }
+    [[nodiscard]] const std::string &expression() const { return expression_; }
+    [[nodiscard]] std::optional<uint64_t> namespace_id() const { return namespace_id_; };
+    [[nodiscard]] const TimeWindow &time_window() const { return time_window_; }
+    // maximum number of matches to report
+    [[nodiscard]] std::optional<uint64_t> limit() const { return limit_; }
+
+private:
+    std::optional<uint32_t> instance_id_;
+    std::optional<uint32_t> breakpoint_id_;
+    std::string expression_;
+    std::optional<uint64_t> namespace_id_;
+    TimeWindow time_window_;
+    std::optional<uint64_t> limit_;
 };
 
 struct DebugBreakPoint;
@@ -429,6 +502,18 @@ private:
     std::string result_;
 };
 
+// matches are streamed back in time order over multiple responses. done is set in the last one
+class FindWhenResponse : public Response {
+public:
+    FindWhenResponse(std::vector<uint64_t> times, bool done);
+    [[nodiscard]] std::string str(bool pretty_print) const override;
+    [[nodiscard]] std::string type() const override { return to_string(RequestType::find_when); }
+
+private:
+    std::vector<uint64_t> times_;
+    bool done_;
+};
+
 class MonitorResponse : public Response {
 public:
     MonitorResponse(uint64_t track_id, uint64_t namespace_id, std::string value);
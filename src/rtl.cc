@@ -3,11 +3,11 @@
 #include <fmt/format.h>
 
 #include <cstdarg>
-#include <queue>
 #include <unordered_set>
 
 #include "log.hh"
 #include "sv_vpi_user.h"
+#include "thread.hh"
 #include "util.hh"
 
 namespace hgdb {
@@ -23,6 +23,16 @@ void VPIProvider::vpi_get_value(vpiHandle expr, p_vpi_value value_p) {
     }
 }
 
+void VPIProvider::vpi_get_values(std::span<const vpiHandle> handles,
+                                 std::span<s_vpi_value> values) {
+    // only lock once for the entire batch
+    std::unique_lock guard(vpi_lock_, std::defer_lock);
+    if (use_lock_getting_value_) guard.lock();
+    for (auto i = 0u; i < handles.size(); i++) {
+        ::vpi_get_value(handles[i], &values[i]);
+    }
+}
+
 PLI_INT32 VPIProvider::vpi_get(PLI_INT32 property, vpiHandle object) {
     std::lock_guard guard(vpi_lock_);
     return ::vpi_get(property, object);
@@ -145,8 +155,9 @@ void RTLSimulatorClient::initialize_vpi(std::shared_ptr<AVPIProvider> vpi) {
     // set simulator information
     set_simulator_info();
 
-    // compute the vpiNet target. this is a special case for Verilator
-    vpi_net_target_ = is_verilator() ? vpiReg : vpiNet;
+    // compute the signal types. this is a special case for Verilator, which reports nets as
+    // vpiReg
+    if (is_verilator()) signal_types_ = {vpiReg};
     const static bool is_commercial = is_vcs() || is_xcelium();
     vpi_->set_use_lock_getting_value(is_commercial);
 }
@@ -154,25 +165,26 @@ void RTLSimulatorClient::initialize_vpi(std::shared_ptr<AVPIProvider> vpi) {
 vpiHandle RTLSimulatorClient::get_handle(const std::string &name) {
     auto full_name = get_full_name(name);
     // if we already queried this handle before
+    if (auto *cached = handle_map_.find(full_name)) [[likely]] {
+        return *cached;
+    }
     std::lock_guard guard(handle_map_lock_);
-    if (handle_map_.find(full_name) != handle_map_.end()) [[likely]] {
-        return handle_map_.at(full_name);
-    } else {
-        // need to query via VPI
-        auto *handle = const_cast<char *>(full_name.c_str());
-        auto *ptr = vpi_->vpi_handle_by_name(handle, nullptr);
-        if (ptr) [[likely]] {
-            // if we actually found the handle, need to store it
-            handle_map_.emplace(full_name, ptr);
-        } else {
-            // full back to brute-force resolving names. usually we have to
-            // deal with verilator. remove []
-            auto tokens = util::get_tokens(full_name, ".[]");
-            ptr = get_handle(tokens);
-            if (ptr) handle_map_.emplace(name, ptr);
-        }
-        return ptr;
+    // another thread may have resolved it while we were waiting
+    if (auto *cached = handle_map_.find(full_name)) {
+        return *cached;
+    }
+    // need to query via VPI
+    auto *handle = const_cast<char *>(full_name.c_str());
+    auto *ptr = vpi_->vpi_handle_by_name(handle, nullptr);
+    if (!ptr) [[unlikely]] {
+        // full back to brute-force resolving names. usually we have to
+        // deal with verilator. remove []
+        auto tokens = util::get_tokens(full_name, ".[]");
+        ptr = get_handle(tokens);
     }
+    // if we actually found the handle, need to store it
+    if (ptr) handle_map_.emplace(full_name, ptr);
+    return ptr;
 }
 
 vpiHandle RTLSimulatorClient::get_handle(const std::vector<std::string> &tokens) {
@@ -227,6 +239,12 @@ vpiHandle RTLSimulatorClient::get_handle(const std::vector<std::string> &tokens)
 }
 
 bool RTLSimulatorClient::is_valid_signal(const std::string &name) {
+    // plain signals and instances are already known to the design hierarchy
+    auto hierarchy = design_hierarchy();
+    auto full_name = get_full_name(name);
+    if (hierarchy->find_signal(full_name)) return true;
+    if (hierarchy->find_instance(full_name)) return false;
+    // anything else, e.g. array elements and slices, has to be resolved through VPI
     auto *handle = get_handle(name);
     if (!handle) return false;
     auto type = get_vpi_type(handle);
@@ -266,14 +284,24 @@ std::optional<int64_t> RTLSimulatorClient::get_value(vpiHandle handle, bool is_s
         return std::nullopt;
     }
 
+    // the epoch has to be read before the simulator value
+    uint64_t epoch = 0;
+    auto const use_snapshot = use_value_snapshot_.load(std::memory_order_relaxed);
+    if (use_snapshot) {
+        epoch = value_snapshot_.epoch();
+        auto value = value_snapshot_.get(handle, epoch);
+        if (value) return value;
+    }
+
     bool is_slice_handle = false;
     auto *target_handle = handle;
 
     if (is_signal) {
+        auto &info = get_handle_info(handle);
         // get value size. Verilator will freak out if the width is larger than 64
         // notice this is mostly cached result
         if (is_verilator()) {
-            auto width = get_vpi_size(handle);
+            auto width = get_vpi_size(handle, info);
             if (width > 64) [[unlikely]] {
                 auto *name = vpi_->vpi_get_str(vpiName, handle);
                 log::log(log::log_level::info,
@@ -284,9 +312,9 @@ std::optional<int64_t> RTLSimulatorClient::get_value(vpiHandle handle, bool is_s
 
         // if we have mock vpi handle, use it
         // optimize for unlikely
-        is_slice_handle = mock_slice_handles_.find(handle) != mock_slice_handles_.end();
+        is_slice_handle = info.slice.has_value();
         if (is_slice_handle) [[unlikely]]
-            handle = std::get<0>(mock_slice_handles_.at(handle));
+            handle = std::get<0>(*info.slice);
     }
 
     s_vpi_value v;
@@ -295,12 +323,97 @@ std::optional<int64_t> RTLSimulatorClient::get_value(vpiHandle handle, bool is_s
     int64_t result = v.value.integer;
 
     if (is_slice_handle) [[unlikely]] {
-        result = get_slice(result, mock_slice_handles_.at(target_handle));
+        result = get_slice(result, *get_slice_info(target_handle));
+    }
+
+    if (use_snapshot) {
+        value_snapshot_.set(target_handle, result, epoch);
     }
 
     return result;
 }
 
+void RTLSimulatorClient::get_values(std::span<const vpiHandle> handles,
+                                    std::span<std::optional<int64_t>> values) {
+    // scratch space is reused across calls to avoid allocation on the evaluation path
+    thread_local std::vector<vpiHandle> pending_handles;
+    thread_local std::vector<s_vpi_value> pending_values;
+    thread_local std::vector<uint64_t> pending_indices;
+    pending_handles.clear();
+    pending_values.clear();
+    pending_indices.clear();
+
+    auto const use_snapshot = use_value_snapshot_.load(std::memory_order_relaxed);
+    uint64_t epoch = use_snapshot ? value_snapshot_.epoch() : 0;
+    for (auto i = 0u; i < handles.size(); i++) {
+        auto *handle = handles[i];
+        values[i] = std::nullopt;
+        if (!handle) [[unlikely]]
+            continue;
+        if (use_snapshot) {
+            auto value = value_snapshot_.get(handle, epoch);
+            if (value) {
+                values[i] = value;
+                continue;
+            }
+        }
+        auto &info = get_handle_info(handle);
+        // Verilator will freak out if the width is larger than 64
+        if (is_verilator() && get_vpi_size(handle, info) > 64) [[unlikely]]
+            continue;
+        if (info.slice) [[unlikely]]
+            handle = std::get<0>(*info.slice);
+
+        s_vpi_value v;
+        v.format = vpiIntVal;
+        pending_handles.emplace_back(handle);
+        pending_values.emplace_back(v);
+        pending_indices.emplace_back(i);
+    }
+
+    if (pending_handles.empty()) return;
+    vpi_->vpi_get_values(pending_handles, pending_values);
+
+    for (auto i = 0u; i < pending_indices.size(); i++) {
+        auto index = pending_indices[i];
+        auto *handle = handles[index];
+        int64_t result = pending_values[i].value.integer;
+        if (pending_handles[i] != handle) [[unlikely]] {
+            result = get_slice(result, *get_slice_info(handle));
+        }
+        if (use_snapshot) {
+            value_snapshot_.set(handle, result, epoch);
+        }
+        values[index] = result;
+    }
+}
+
+bool RTLSimulatorClient::get_wide_value(vpiHandle handle, WideValue &value) {
+    if (!handle) [[unlikely]]
+        return false;
+    auto &info = get_handle_info(handle);
+    auto width = get_vpi_size(handle, info);
+    // slices of wide signals are not supported
+    if (width == 0 || width > WideValue::max_width || info.slice) [[unlikely]] {
+        return false;
+    }
+
+    // value-initialized so that providers without vector support leave it as nullptr
+    s_vpi_value v{};
+    v.format = vpiVectorVal;
+    vpi_->vpi_get_value(handle, &v);
+    auto const *vector = v.value.vector;
+    if (!vector) [[unlikely]]
+        return false;
+    value = {};
+    // the buffer is owned by the simulator and holds 32 bits per entry
+    for (auto i = 0u; i < (width + 31) / 32; i++) {
+        auto bits = static_cast<uint64_t>(static_cast<uint32_t>(vector[i].aval & ~vector[i].bval));
+        value.words[i / 2] |= bits << (32 * (i % 2));
+    }
+    return true;
+}
+
 std::optional<uint32_t> RTLSimulatorClient::get_signal_width(vpiHandle handle) {
     auto w = get_vpi_size(handle);
     if (w == 0) [[unlikely]] {
@@ -351,7 +464,8 @@ std::optional<std::string> RTLSimulatorClient::get_str_value(vpiHandle handle, b
     if (!handle) [[unlikely]] {
         return std::nullopt;
     }
-    auto type = get_vpi_type(handle);
+    auto &info = get_handle_info(handle);
+    auto type = get_vpi_type(handle, info);
     if (type == vpiModule) [[unlikely]] {
         return std::nullopt;
     }
@@ -359,18 +473,18 @@ std::optional<std::string> RTLSimulatorClient::get_str_value(vpiHandle handle, b
     if (is_signal) {
         vpiHandle request_handle = handle;
 
-        bool is_slice = mock_slice_handles_.find(handle) != mock_slice_handles_.end();
-        handle = is_slice ? std::get<0>(mock_slice_handles_.at(handle)) : handle;
+        bool is_slice = info.slice.has_value();
+        handle = is_slice ? std::get<0>(*info.slice) : handle;
 
         s_vpi_value v;
         v.format = is_slice ? vpiBinStrVal : vpiHexStrVal;
         vpi_->vpi_get_value(handle, &v);
         std::string result = v.value.str;
         if (is_slice) [[unlikely]] {
-            result = get_slice(result, mock_slice_handles_.at(request_handle));
+            result = get_slice(result, *info.slice);
         }
         // we only add 0x to any signal that has more than 1bit
-        auto width = get_vpi_size(request_handle);
+        auto width = get_vpi_size(request_handle, info);
         if (width > 1) result = fmt::format("0x{0}", result);
         return result;
     } else {
@@ -395,6 +509,9 @@ bool RTLSimulatorClient::set_value(vpiHandle handle, int64_t value) {
     // based on the spec, there is no way to tell whether it is successful or not
     // as a result, we use a magic number to indicate if it fails for emulator
     auto *res = vpi_->vpi_put_value(handle, &vpi_value, nullptr, vpiNoDelay);
+    // the value may have changed. notice that slices of this signal, if any, will be refreshed
+    // at the next cycle
+    value_snapshot_.invalidate(handle);
     auto *invalid_value = (vpiHandle)std::numeric_limits<uint64_t>::max();
     return invalid_value != res;
 }
@@ -406,31 +523,43 @@ bool RTLSimulatorClient::set_value(const std::string &name, int64_t value) {
 
 std::unordered_map<std::string, vpiHandle> RTLSimulatorClient::get_module_signals(
     const std::string &name) {
-    if (module_signals_cache_.find(name) != module_signals_cache_.end()) {
-        return module_signals_cache_.at(name);
+    auto hierarchy = design_hierarchy();
+    std::vector<DesignSignal> module_signals;
+    const std::vector<DesignSignal> *signals;
+    if (auto const *instance = hierarchy->find_instance(get_full_name(name))) [[likely]] {
+        signals = &instance->signals;
+    } else {
+        // the module is not reachable from the top, e.g. in Verilator
+        auto *module_handle = get_handle(name);
+        if (!module_handle) return {};
+        // need to make sure it is module type
+        auto module_handle_type = get_vpi_type(module_handle);
+        if (module_handle_type != vpiModule) return {};
+        module_signals = DesignHierarchy::scan_signals(vpi_.get(), module_handle, signal_types_);
+        signals = &module_signals;
     }
-    auto *module_handle = get_handle(name);
-    if (!module_handle) return {};
-    // need to make sure it is module type
-    auto module_handle_type = get_vpi_type(module_handle);
-    if (module_handle_type != vpiModule) return {};
 
     std::unordered_map<std::string, vpiHandle> result;
-    // get all net from that particular module
-    auto *net_iter = vpi_->vpi_iterate(static_cast<int>(vpi_net_target_), module_handle);
-    if (!net_iter) return {};
-    vpiHandle net_handle;
-    while ((net_handle = vpi_->vpi_scan(net_iter)) != nullptr) {
-        char *name_raw = vpi_->vpi_get_str(vpiName, net_handle);
-        std::string n = name_raw;
-        result.emplace(n, net_handle);
+    for (auto const &signal : *signals) {
+        result.emplace(signal.name, signal.handle);
     }
-
-    // store the cache
-    module_signals_cache_.emplace(name, result);
     return result;
 }
 
+std::shared_ptr<const DesignHierarchy> RTLSimulatorClient::design_hierarchy() {
+    std::lock_guard guard(design_hierarchy_lock_);
+    if (!design_hierarchy_) {
+        design_hierarchy_ =
+            std::make_shared<DesignHierarchy>(vpi_.get(), signal_types_, vpi_->has_defname());
+    }
+    return design_hierarchy_;
+}
+
+void RTLSimulatorClient::set_design_hierarchy(std::shared_ptr<const DesignHierarchy> hierarchy) {
+    std::lock_guard guard(design_hierarchy_lock_);
+    design_hierarchy_ = std::move(hierarchy);
+}
+
 std::string RTLSimulatorClient::get_full_name(const std::string &name) const {
     if (name.starts_with(root_name)) {
         // this is absolute reference.
@@ -579,6 +708,37 @@ std::string resolve_rtl_path(const std::string &path) {
     return res;
 }
 
+uint64_t RTLSimulatorClient::resolve_handles(
+    const std::vector<std::string> &names, ThreadPool &pool,
+    const std::function<void(uint64_t, uint64_t)> &on_progress) {
+    // progress is reported after each round
+    auto constexpr num_rounds = 10u;
+    auto constexpr batch_size = 64u;
+    std::atomic<uint64_t> num_resolved = 0;
+    auto round_size = std::max<uint64_t>((names.size() + num_rounds - 1) / num_rounds, 1);
+    for (uint64_t round_start = 0; round_start < names.size(); round_start += round_size) {
+        auto round_end = std::min<uint64_t>(round_start + round_size, names.size());
+        pool.parallel_for(round_end - round_start, batch_size, [&](uint64_t start, uint64_t end) {
+            for (auto i = round_start + start; i < round_start + end; i++) {
+                // get_handle only locks when the name has to go through VPI
+                auto *handle = get_handle(resolve_rtl_path(names[i]));
+                if (!handle) continue;
+                num_resolved.fetch_add(1, std::memory_order_relaxed);
+                // type and width are needed by every value read
+                auto &info = get_handle_info(handle);
+                if (info.type.load(std::memory_order_relaxed) == HandleInfo::unknown_type ||
+                    info.width.load(std::memory_order_relaxed) == 0) {
+                    std::lock_guard guard(handle_map_lock_);
+                    get_vpi_type(handle, info);
+                    get_vpi_size(handle, info);
+                }
+            }
+        });
+        if (on_progress) on_progress(round_end, names.size());
+    }
+    return num_resolved.load();
+}
+
 // NOLINTNEXTLINE
 std::vector<std::pair<std::string, std::string>> RTLSimulatorClient::resolve_rtl_variable(
     const std::string &front_name, std::string rtl_name) {
@@ -709,28 +869,15 @@ std::vector<RTLSimulatorClient::IPMapping> RTLSimulatorClient::compute_hierarchy
     const std::unordered_set<std::string> &top_names) {
     std::vector<RTLSimulatorClient::IPMapping> result;
     // we do a BFS search from the top;
-    std::queue<vpiHandle> handle_queues;
-    handle_queues.emplace(nullptr);
-    while ((!handle_queues.empty())) {
-        // scan through the design hierarchy
-        auto *mod_handle = handle_queues.front();
-        handle_queues.pop();
-        auto *handle_iter = vpi_->vpi_iterate(vpiModule, mod_handle);
-        if (!handle_iter) continue;
-        vpiHandle child_handle;
-        while ((child_handle = vpi_->vpi_scan(handle_iter)) != nullptr) {
-            std::string def_name = vpi_->vpi_get_str(vpiDefName, child_handle);
-            if (top_names.find(def_name) != top_names.end()) {
-                // we found a match
-                std::string hierarchy_name = vpi_->vpi_get_str(vpiFullName, child_handle);
-                // adding . at the end
-                hierarchy_name = fmt::format("{0}.", hierarchy_name);
-                // add it to the mapping
-                result.emplace_back(std::make_pair(def_name, hierarchy_name));
-            }
-            handle_queues.emplace(child_handle);
+    design_hierarchy()->visit([&](const DesignInstance &instance) {
+        if (top_names.find(instance.def_name) != top_names.end()) {
+            // we found a match
+            // adding . at the end
+            auto hierarchy_name = fmt::format("{0}.", instance.full_name);
+            // add it to the mapping
+            result.emplace_back(std::make_pair(instance.def_name, hierarchy_name));
         }
-    }
+    });
 
     return result;
 }
@@ -789,53 +936,41 @@ std::vector<RTLSimulatorClient::IPMapping> RTLSimulatorClient::compute_hierarchy
     std::unordered_set<std::string> empty_top;
 
     // we walk the hierarchy
+    auto hierarchy = design_hierarchy();
+    if (hierarchy->root().children.empty() && is_verilator() && !map_instance_mapping.empty()) {
+        // verilator... why would you do this?
+        auto const &top_name = map_instance_mapping.begin()->first;
+        return {{top_name, fmt::format("TOP.{0}.", top_name)}};
+    }
     // we do a BFS search from the top;
-    std::queue<vpiHandle> handle_queues;
-    handle_queues.emplace(nullptr);
-    while ((!handle_queues.empty())) {
-        // scan through the design hierarchy
-        auto *mod_handle = handle_queues.front();
-        handle_queues.pop();
-        auto *handle_iter = vpi_->vpi_iterate(vpiModule, mod_handle);
-        if (!handle_iter) {
-            if (is_verilator() && !mod_handle) {
-                // verilator... why would you do this?
-                auto const &top_name = map_instance_mapping.begin()->first;
-                return {{top_name, fmt::format("TOP.{0}.", top_name)}};
-            }
-            continue;
-        }
-        vpiHandle child_handle;
-        while ((child_handle = vpi_->vpi_scan(handle_iter)) != nullptr) {
-            std::string hierarchy_name = vpi_->vpi_get_str(vpiFullName, child_handle);
-
-            for (auto const &[top, path] : map_tokens) {
-                if (path.empty()) {
-                    if (empty_top.find(top) != empty_top.end()) continue;
-                    auto tokens = util::get_tokens(hierarchy_name, ".");
-                    // in Verilator TOP is not an instance!
-                    if (tokens.size() > 1) {
-                        // it has to be larger than 1
-                        auto prefix = hierarchy_name + ".";
-                        empty_top.emplace(top);
-                        result.emplace_back(std::make_pair(top, prefix));
-                        continue;
-                    } else if (is_verilator() && tokens.size() == 1 && tokens[0] == top) {
-                        // this is verilator hack
-                        auto prefix = "TOP." + hierarchy_name + ".";
-                        empty_top.emplace(top);
-                        result.emplace_back(std::make_pair(top, prefix));
-                        continue;
-                    }
-                }
-                auto [res, prefix] = match(hierarchy_name, path);
-                if (res) {
+    hierarchy->visit([&](const DesignInstance &instance) {
+        auto const &hierarchy_name = instance.full_name;
+
+        for (auto const &[top, path] : map_tokens) {
+            if (path.empty()) {
+                if (empty_top.find(top) != empty_top.end()) continue;
+                auto tokens = util::get_tokens(hierarchy_name, ".");
+                // in Verilator TOP is not an instance!
+                if (tokens.size() > 1) {
+                    // it has to be larger than 1
+                    auto prefix = hierarchy_name + ".";
+                    empty_top.emplace(top);
+                    result.emplace_back(std::make_pair(top, prefix));
+                    continue;
+                } else if (is_verilator() && tokens.size() == 1 && tokens[0] == top) {
+                    // this is verilator hack
+                    auto prefix = "TOP." + hierarchy_name + ".";
+                    empty_top.emplace(top);
                     result.emplace_back(std::make_pair(top, prefix));
+                    continue;
                 }
             }
-            handle_queues.emplace(child_handle);
+            auto [res, prefix] = match(hierarchy_name, path);
+            if (res) {
+                result.emplace_back(std::make_pair(top, prefix));
+            }
         }
-    }
+    });
 
     return result;
 }
@@ -873,10 +1008,15 @@ std::vector<std::string> RTLSimulatorClient::get_clocks_from_design() {
     // this employ some naming heuristics to get the name
     std::vector<std::string> result;
     auto const &instance_name = hierarchy_name_prefix_map_.second;
+    auto hierarchy = design_hierarchy();
 
-    auto is_valid_signal = [&](std::string_view signal_name) -> bool {
+    auto is_valid_signal = [&](const std::string &signal_name) -> bool {
+        // most clocks are plain signals, whose width is already known
+        if (auto const *signal = hierarchy->find_signal(signal_name)) {
+            return signal->width == 1;
+        }
         // test to see if there is a signal name that match
-        auto *handle = vpi_->vpi_handle_by_name(const_cast<char *>(signal_name.data()), nullptr);
+        auto *handle = vpi_->vpi_handle_by_name(const_cast<char *>(signal_name.c_str()), nullptr);
         if (handle) {
             // make sure it's 1 bit as well
             int width = vpi_->vpi_get(vpiSize, handle);
@@ -966,38 +1106,75 @@ bool RTLSimulatorClient::reverse_last_posedge(const std::vector<vpiHandle> &clk_
 bool RTLSimulatorClient::rewind(uint64_t time, const std::vector<vpiHandle> &clk_handles) {
     AVPIProvider::rewind_data data{.time = time, .clock_signals = clk_handles};
 
-    return vpi_->vpi_rewind(&data);
+    auto res = vpi_->vpi_rewind(&data);
+    // simulation time changed, every value is stale now
+    if (res) value_snapshot_.next_epoch();
+    return res;
+}
+
+bool RTLSimulatorClient::get_value_changes(vpiHandle handle, uint64_t start, uint64_t end,
+                                           std::vector<std::pair<uint64_t, int64_t>> &changes) {
+    if (!handle) [[unlikely]]
+        return false;
+    auto const *slice = get_slice_info(handle);
+    if (!slice) {
+        return vpi_->vpi_get_value_changes(handle, start, end, changes);
+    }
+    if (!vpi_->vpi_get_value_changes(std::get<0>(*slice), start, end, changes)) {
+        return false;
+    }
+    for (auto &[time, value] : changes) {
+        value = get_slice(value, *slice);
+    }
+    return true;
 }
 
 void RTLSimulatorClient::set_vpi_allocator(const std::function<vpiHandle()> &func) {
     vpi_allocator_ = func;
 }
 
+RTLSimulatorClient::HandleInfo &RTLSimulatorClient::get_handle_info(vpiHandle handle) {
+    if (auto *info = handle_info_.find(handle)) [[likely]] {
+        return *info;
+    }
+    return *handle_info_.emplace(handle).first;
+}
+
 PLI_INT32 RTLSimulatorClient::get_vpi_type(vpiHandle handle) {
     if (!handle) return vpiError;
-    std::lock_guard guard(cached_vpi_types_lock_);
-    if (cached_vpi_types_.find(handle) != cached_vpi_types_.end()) [[likely]] {
-        return cached_vpi_types_.at(handle);
-    } else {
-        auto t = vpi_->vpi_get(vpiType, handle);
-        cached_vpi_types_.emplace(handle, t);
-        return t;
+    return get_vpi_type(handle, get_handle_info(handle));
+}
+
+PLI_INT32 RTLSimulatorClient::get_vpi_type(vpiHandle handle, HandleInfo &info) {
+    auto t = info.type.load(std::memory_order_relaxed);
+    if (t == HandleInfo::unknown_type) [[unlikely]] {
+        // racing threads get the same answer from the simulator
+        t = vpi_->vpi_get(vpiType, handle);
+        info.type.store(t, std::memory_order_relaxed);
     }
+    return t;
 }
 
 uint32_t RTLSimulatorClient::get_vpi_size(vpiHandle handle) {
     if (!handle) return 0;
-    std::lock_guard guard(cached_vpi_size_lock_);
-    if (cached_vpi_size_.find(handle) != cached_vpi_size_.end()) [[likely]] {
-        return cached_vpi_size_.at(handle);
-    } else {
+    return get_vpi_size(handle, get_handle_info(handle));
+}
+
+uint32_t RTLSimulatorClient::get_vpi_size(vpiHandle handle, HandleInfo &info) {
+    auto width = info.width.load(std::memory_order_relaxed);
+    if (width == 0) [[unlikely]] {
         auto t = vpi_->vpi_get(vpiSize, handle);
-        if (t != vpiUndefined) [[likely]] {
-            cached_vpi_size_.emplace(handle, t);
-            return t;
-        }
-        return 0;
+        if (t == vpiUndefined) [[unlikely]]
+            return 0;
+        width = static_cast<uint32_t>(t);
+        info.width.store(width, std::memory_order_relaxed);
     }
+    return width;
+}
+
+const RTLSimulatorClient::SliceInfo *RTLSimulatorClient::get_slice_info(vpiHandle handle) const {
+    auto const *info = handle_info_.find(handle);
+    return info && info->slice ? &*info->slice : nullptr;
 }
 
 RTLSimulatorClient::~RTLSimulatorClient() {
@@ -1065,19 +1242,17 @@ vpiHandle RTLSimulatorClient::add_mock_slice_vpi(vpiHandle parent, const std::st
     if (!slice_num) return nullptr;
     auto [hi, lo] = *slice_num;
     auto *new_handle = vpi_allocator_ ? (*vpi_allocator_)() : ++mock_slice_handle_counter_;
-    mock_slice_handles_.emplace(new_handle, std::make_tuple(parent, hi, lo));
+    handle_info_.emplace(new_handle, std::make_tuple(parent, hi, lo));
     return new_handle;
 }
 
 vpiHandle RTLSimulatorClient::get_handle_raw(const std::string &handle_name) {
-    vpiHandle ptr = nullptr;
-    if (handle_map_.find(handle_name) != handle_map_.end()) {
-        ptr = handle_map_.at(handle_name);
-    } else {
-        ptr = vpi_->vpi_handle_by_name(const_cast<char *>(handle_name.c_str()), nullptr);
-        if (ptr) {
-            handle_map_.emplace(handle_name, ptr);
-        }
+    if (auto *cached = handle_map_.find(handle_name)) {
+        return *cached;
+    }
+    auto *ptr = vpi_->vpi_handle_by_name(const_cast<char *>(handle_name.c_str()), nullptr);
+    if (ptr) {
+        handle_map_.emplace(handle_name, ptr);
     }
     return ptr;
 }
@@ -1,19 +1,28 @@
 #ifndef HGDB_RTL_HH
 #define HGDB_RTL_HH
 
+#include <atomic>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "concurrent_map.hh"
+#include "hierarchy.hh"
+#include "snapshot.hh"
 #include "vpi_user.h"
+#include "wide.hh"
 
 namespace hgdb {
 
+class ThreadPool;
+
 // abstract class to handle VPI implementation
 // needed for mock tests. In real world, always use vendor provided implementation
 class AVPIProvider {
@@ -46,6 +55,21 @@ public:
         std::vector<vpiHandle> clock_signals;
     };
     virtual bool vpi_rewind(rewind_data *reverse_data) { return false; }
+    // value changes of a signal within [start, end], sorted by time. the first entry is the
+    // value at start. only available when the whole trace is accessible, e.g. in replay
+    virtual bool vpi_get_value_changes(vpiHandle handle, uint64_t start, uint64_t end,
+                                       std::vector<std::pair<uint64_t, int64_t>> &changes) {
+        return false;
+    }
+
+    // batched value read. format has to be set for each value before the call.
+    // by default it loops through each handle
+    virtual void vpi_get_values(std::span<const vpiHandle> handles,
+                                std::span<s_vpi_value> values) {
+        for (auto i = 0u; i < handles.size(); i++) {
+            vpi_get_value(handles[i], &values[i]);
+        }
+    }
 
     void set_use_lock_getting_value(bool value) { use_lock_getting_value_ = value; }
 
@@ -74,6 +98,8 @@ class VPIProvider : public AVPIProvider {
                             PLI_INT32 flags) override;
     vpiHandle vpi_register_systf(p_vpi_systf_data data) override;
     vpiHandle vpi_handle(int type, vpiHandle scope) override;
+    void vpi_get_values(std::span<const vpiHandle> handles,
+                        std::span<s_vpi_value> values) override;
 
     bool has_defname() override;
 
@@ -92,8 +118,17 @@ public:
     vpiHandle get_handle(const std::string &name);
     vpiHandle get_handle(const std::vector<std::string> &tokens);
     bool is_valid_signal(const std::string &name);
+    // fills the handle cache ahead of time. name mapping runs on the pool workers while VPI
+    // calls are serialized. on_progress(done, total) is called from the calling thread.
+    // returns the number of names that resolved to a handle
+    uint64_t resolve_handles(const std::vector<std::string> &names, ThreadPool &pool,
+                             const std::function<void(uint64_t, uint64_t)> &on_progress);
     std::optional<int64_t> get_value(const std::string &name);
     std::optional<int64_t> get_value(vpiHandle handle, bool signal = true);
+    // batched version of get_value. values has to be the same size as handles
+    void get_values(std::span<const vpiHandle> handles, std::span<std::optional<int64_t>> values);
+    // signals up to WideValue::max_width bits, read as a vector value. x and z bits read as 0
+    bool get_wide_value(vpiHandle handle, WideValue &value);
     std::optional<uint32_t> get_signal_width(vpiHandle handle);
     std::optional<std::string> get_str_value(const std::string &name);
     std::optional<std::string> get_str_value(vpiHandle handle, bool is_signal = true);
@@ -101,6 +136,10 @@ public:
     bool set_value(const std::string &name, int64_t value);
     using ModuleSignals = std::unordered_map<std::string, vpiHandle>;
     ModuleSignals get_module_signals(const std::string &name);
+    // instance trie of the whole design. built on first use and shared with other clients
+    // through set_design_hierarchy, since all of them talk to the same simulator
+    std::shared_ptr<const DesignHierarchy> design_hierarchy();
+    void set_design_hierarchy(std::shared_ptr<const DesignHierarchy> hierarchy);
     [[nodiscard]] std::string get_full_name(const std::string &name) const;
     [[nodiscard]] std::string get_full_name(vpiHandle handle);
     [[nodiscard]] bool is_absolute_path(const std::string &name) const;
@@ -143,6 +182,15 @@ public:
     [[maybe_unused]] bool reverse_last_posedge(const std::vector<vpiHandle> &clk_handles);
 
     [[nodiscard]] bool rewind(uint64_t time, const std::vector<vpiHandle> &clk_handles);
+    // signal history, see AVPIProvider::vpi_get_value_changes
+    [[nodiscard]] bool get_value_changes(vpiHandle handle, uint64_t start, uint64_t end,
+                                         std::vector<std::pair<uint64_t, int64_t>> &changes);
+
+    // per-cycle value snapshot. when enabled, integer values are read from the simulator once
+    // per epoch. the debugger enables it and bumps the epoch at the beginning of each evaluation
+    // cycle, and disables it once the cycle is done since the simulator moves on afterwards
+    void set_use_value_snapshot(bool value) { use_value_snapshot_ = value; }
+    void next_value_snapshot() { value_snapshot_.next_epoch(); }
 
     // if the client uses some custom vpiHandle allocator, they need to set this to avoid
     // conflicts
@@ -169,28 +217,47 @@ public:
     std::optional<RTLSimulatorClient::AssertInfo> get_assert_info();
 
 private:
-    std::unordered_map<std::string, vpiHandle> handle_map_;
+    // handle lookups are lock-free. resolving a new name goes through VPI and is serialized
+    // by handle_map_lock_
+    ConcurrentMap<std::string, vpiHandle> handle_map_;
     std::mutex handle_map_lock_;
     std::pair<std::string, std::string> hierarchy_name_prefix_map_;
     // VPI provider
     std::shared_ptr<AVPIProvider> vpi_;
-    uint32_t vpi_net_target_ = vpiNet;
+    // object types iterated to list module signals
+    std::vector<PLI_INT32> signal_types_ = {vpiNet, vpiReg};
     // callbacks
     std::unordered_map<std::string, vpiHandle> cb_handles_;
     std::mutex cb_handles_lock_;
-    std::unordered_map<vpiHandle, PLI_INT32> cached_vpi_types_;
-    std::mutex cached_vpi_types_lock_;
-    std::unordered_map<vpiHandle, uint32_t> cached_vpi_size_;
-    std::mutex cached_vpi_size_lock_;
+    // everything the evaluation path needs to know about a handle, so that a single lookup
+    // is enough. type and width are queried from the simulator on first use
+    using SliceInfo = std::tuple<vpiHandle, uint32_t, uint32_t>;
+    struct HandleInfo {
+        static constexpr PLI_INT32 unknown_type = std::numeric_limits<PLI_INT32>::min();
+        std::atomic<PLI_INT32> type = unknown_type;
+        // 0 if not known yet
+        std::atomic<uint32_t> width = 0;
+        // only set for mock slice handles. parent handle, hi, and lo
+        std::optional<SliceInfo> slice;
+
+        HandleInfo() = default;
+        explicit HandleInfo(SliceInfo slice) : slice(slice) {}
+    };
+    ConcurrentMap<vpiHandle, HandleInfo> handle_info_;
+
+    // values shared by all breakpoints, monitors and hit reports within a cycle
+    SignalValueSnapshot value_snapshot_;
+    // written by the simulation thread, read by any thread that reads values
+    std::atomic<bool> use_value_snapshot_ = false;
 
-    // cached module signals
-    // this is to avoid looping through instances repeatedly
-    std::unordered_map<std::string, ModuleSignals> module_signals_cache_;
+    // instance mapping, clock search, and module signals all come from here, which avoids
+    // looping through instances repeatedly
+    std::shared_ptr<const DesignHierarchy> design_hierarchy_;
+    std::mutex design_hierarchy_lock_;
 
     // notice that to my best knowledge, there is no command VPI routine that shared by all
     // simulator vendors that deal with slices. As a result, we need to fake vpiHandles to deal
-    // with slices
-    std::unordered_map<vpiHandle, std::tuple<vpiHandle, uint32_t, uint32_t>> mock_slice_handles_;
+    // with slices. slice information is stored in handle_info_
     vpiHandle mock_slice_handle_counter_ = nullptr;
     std::optional<std::function<vpiHandle()>> vpi_allocator_;
 
@@ -220,8 +287,13 @@ private:
     vpiHandle access_arrays(StringIterator begin, StringIterator end, vpiHandle var_handle);
 
     // cached helper methods
+    HandleInfo &get_handle_info(vpiHandle handle);
     PLI_INT32 get_vpi_type(vpiHandle handle);
+    PLI_INT32 get_vpi_type(vpiHandle handle, HandleInfo &info);
     uint32_t get_vpi_size(vpiHandle handle);
+    uint32_t get_vpi_size(vpiHandle handle, HandleInfo &info);
+    // nullptr if the handle is not a mock slice handle
+    [[nodiscard]] const SliceInfo *get_slice_info(vpiHandle handle) const;
 
     // other helper functions
     void remove_call_back(vpiHandle cb_handle);
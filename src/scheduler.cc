@@ -1,5 +1,8 @@
 #include "scheduler.hh"
 
+#include <algorithm>
+#include <limits>
+
 #include "debug.hh"
 #include "fmt/format.h"
 #include "log.hh"
@@ -26,7 +29,17 @@ Scheduler::Scheduler(DebuggerNamespaceManager &namespaces, SymbolTableProvider *
     clock_handles_.reserve(clk_names.size());
     for (auto const &clk_name : clk_names) {
         auto *handle = namespaces_.default_rtl()->get_handle(clk_name);
-        if (handle) clock_handles_.emplace_back(handle);
+        if (handle) {
+            clock_handles_.emplace_back(handle);
+            clock_names_.emplace_back(clk_name);
+        }
+    }
+}
+
+Scheduler::~Scheduler() {
+    // callbacks hold pointers into the dependency table
+    for (auto const &[handle, dependency] : dependencies_) {
+        dependency->rtl->remove_call_back(dependency->callback_name);
     }
 }
 
@@ -58,10 +71,9 @@ std::vector<DebugBreakPoint *> Scheduler::next_step_over_breakpoints() {
         // need to grab the first one, doesn't matter which one
         if (!bp_ordering_.empty()) next_breakpoint_id = bp_ordering_[0];
     } else {
-        auto current_id = *current_breakpoint_id_;
-        auto pos = std::find(bp_ordering_.begin(), bp_ordering_.end(), current_id);
-        if (pos != bp_ordering_.end()) {
-            auto index = static_cast<uint64_t>(std::distance(bp_ordering_.begin(), pos));
+        auto pos = bp_ordering_table_.find(*current_breakpoint_id_);
+        if (pos != bp_ordering_table_.end()) {
+            auto index = pos->second;
             if (index != (bp_ordering_.size() - 1)) {
                 next_breakpoint_id = bp_ordering_[index + 1];
             }
@@ -69,14 +81,22 @@ std::vector<DebugBreakPoint *> Scheduler::next_step_over_breakpoints() {
     }
     if (!next_breakpoint_id) return {};
     current_breakpoint_id_ = next_breakpoint_id;
-    // need to get a new breakpoint
-    auto bp_info = db_->get_breakpoint(*current_breakpoint_id_);
-    return create_next_breakpoints(bp_info);
+    return create_next_breakpoints(*current_breakpoint_id_);
+}
+
+bool Scheduler::skip_evaluation(const DebugBreakPoint &bp) const {
+    if (bp.condition == DebugBreakPoint::Condition::always_false ||
+        !bp.time_window.contains(current_time_)) {
+        return true;
+    }
+    // breakpoints in other clock domains are evaluated by their own clock
+    return current_clock_domain_ && bp.clock_domain && *bp.clock_domain != *current_clock_domain_;
 }
 
 std::vector<DebugBreakPoint *> Scheduler::next_normal_breakpoints() {
     // if no breakpoint inserted. return early
     std::lock_guard guard(breakpoint_lock_);
+    update_breakpoint_view();
     if (breakpoints_.empty()) return {};
     // we need to make the experience the same as debugging software
     // as a result, when user add new breakpoints to the list that has high priority,
@@ -84,24 +104,24 @@ std::vector<DebugBreakPoint *> Scheduler::next_normal_breakpoints() {
     // maybe revisit this logic later? doesn't seem to be correct to me where there are
     // breakpoint inserted during breakpoint hit
     uint64_t index = 0;
-    // find index
+    // find index of the last evaluated one
     std::optional<uint64_t> pos;
-    for (uint64_t i = 0; i < breakpoints_.size(); i++) {
-        if (breakpoints_[i]->evaluated) {
-            pos = i;
+    for (auto i = breakpoints_.size(); i > 0; i--) {
+        if (breakpoints_[i - 1]->evaluated) {
+            pos = i - 1;
+            break;
         }
     }
     if (pos) {
         // we have a last hit
-        if (*pos + 1 < breakpoints_.size()) {
-            index = *pos + 1;
-        } else {
-            // the end
-            return {};
-        }
+        index = *pos + 1;
     }
+    // skip breakpoints that can never be hit
+    while (index < breakpoints_.size() && skip_evaluation(*breakpoints_[index])) index++;
+    // the end
+    if (index == breakpoints_.size()) return {};
 
-    std::vector<DebugBreakPoint *> result{breakpoints_[index].get()};
+    std::vector<DebugBreakPoint *> result{breakpoints_[index]};
 
     // by default, we generate as many breakpoints as possible to evaluate
     // this can be turned off by client's request (changed via option-change request)
@@ -127,9 +147,8 @@ std::vector<DebugBreakPoint *> Scheduler::next_step_back_breakpoints() {
         // can't roll back if the current breakpoint id is not set
         return {};
     } else {
-        auto current_id = *current_breakpoint_id_;
-        auto pos = std::find(bp_ordering_.begin(), bp_ordering_.end(), current_id);
-        auto index = static_cast<uint64_t>(std::distance(bp_ordering_.begin(), pos));
+        auto pos = bp_ordering_table_.find(*current_breakpoint_id_);
+        auto index = pos != bp_ordering_table_.end() ? pos->second : bp_ordering_.size();
         if (index != 0) {
             next_breakpoint_id = bp_ordering_[index - 1];
         } else {
@@ -151,14 +170,13 @@ std::vector<DebugBreakPoint *> Scheduler::next_step_back_breakpoints() {
     if (!next_breakpoint_id) return {};
 
     current_breakpoint_id_ = next_breakpoint_id;
-    // need to get a new breakpoint
-    auto bp_info = db_->get_breakpoint(*current_breakpoint_id_);
-    return create_next_breakpoints(bp_info);
+    return create_next_breakpoints(*current_breakpoint_id_);
 }
 
 std::vector<DebugBreakPoint *> Scheduler::next_reverse_breakpoints() {
     // if no breakpoint inserted. return early
     std::lock_guard guard(breakpoint_lock_);
+    update_breakpoint_view();
     if (breakpoints_.empty()) return {};
     // we basically reverse the search of the normal breakpoint
 
@@ -204,7 +222,13 @@ std::vector<DebugBreakPoint *> Scheduler::next_reverse_breakpoints() {
         current_breakpoint_id_ = std::nullopt;
         return {};
     }
-    result.emplace_back(breakpoints_[*target_index].get());
+    // skip breakpoints that can never be hit
+    while (*target_index > 0 && skip_evaluation(*breakpoints_[*target_index])) (*target_index)--;
+    if (skip_evaluation(*breakpoints_[*target_index])) {
+        current_breakpoint_id_ = std::nullopt;
+        return {};
+    }
+    result.emplace_back(breakpoints_[*target_index]);
     // if it's not single thread mode
     if (!single_thread_mode_) {
         scan_breakpoints(*target_index, false, result);
@@ -219,132 +243,221 @@ std::vector<DebugBreakPoint *> Scheduler::next_reverse_breakpoints() {
 }
 
 DebugBreakPoint *Scheduler::get_breakpoint(uint32_t id) const {
-    auto pos = std::find_if(breakpoints_.begin(), breakpoints_.end(),
-                            [id](auto const &b) { return b->id == id; });
-    if (pos != breakpoints_.end()) [[likely]] {
-        return pos->get();
+    auto pos = breakpoint_index_.find(id);
+    if (pos != breakpoint_index_.end()) [[likely]] {
+        return pos->second.front();
     } else {
         return nullptr;
     }
 }
 
-std::vector<DebugBreakPoint *> Scheduler::create_next_breakpoints(
-    const std::optional<BreakPoint> &bp_info) {
-    if (!bp_info) return {};
-    std::string cond = bp_info->condition.empty() ? "1" : bp_info->condition;
-    auto instance_name = db_->get_instance_name(*bp_info->instance_id);
-    auto const &namespaces = namespaces_.get_namespaces(instance_name);
-    std::vector<DebugBreakPoint *> res;
-    res.reserve(namespaces.size());
-    next_temp_breakpoints_.resize(namespaces.size());
-    for (auto i = 0u; i < next_temp_breakpoints_.size(); i++) {
-        auto &next_temp_breakpoint_ = next_temp_breakpoints_[i];
-        auto *ns = namespaces[i];
-        next_temp_breakpoint_.id = *current_breakpoint_id_;
-        next_temp_breakpoint_.instance_id = *bp_info->instance_id;
-        next_temp_breakpoint_.ns_id = ns->id;
-        next_temp_breakpoint_.enable_expr = std::make_unique<DebugExpression>(cond);
-        next_temp_breakpoint_.filename = bp_info->filename;
-        next_temp_breakpoint_.line_num = bp_info->line_num;
-        next_temp_breakpoint_.column_num = bp_info->column_num;
-        next_temp_breakpoint_.evaluated = true;
-        util::validate_expr(ns->rtl.get(), db_, next_temp_breakpoint_.enable_expr.get(),
-                            next_temp_breakpoint_.id, next_temp_breakpoint_.instance_id);
-        res.emplace_back(&next_temp_breakpoint_);
+uint64_t Scheduler::execution_order(uint32_t bp_id) const {
+    auto pos = bp_ordering_table_.find(bp_id);
+    // breakpoints unknown to the ordering table are evaluated last
+    return pos != bp_ordering_table_.end() ? pos->second : std::numeric_limits<uint64_t>::max();
+}
+
+DebugBreakPoint *Scheduler::insert_breakpoint(std::unique_ptr<DebugBreakPoint> bp) {
+    // instances of the same breakpoint stay in insertion order
+    bp->sequence = next_sequence_++;
+    auto key = std::make_pair(execution_order(bp->id), bp->sequence);
+    auto *ptr = breakpoint_storage_.emplace(key, std::move(bp)).first->second.get();
+    breakpoints_dirty_ = true;
+    breakpoint_index_[ptr->id].emplace_back(ptr);
+    watch_dependencies(ptr);
+    return ptr;
+}
+
+std::unique_ptr<DebugBreakPoint> Scheduler::erase_breakpoint(DebugBreakPoint *bp) {
+    auto id = bp->id;
+    auto pos = breakpoint_storage_.find(std::make_pair(execution_order(id), bp->sequence));
+    if (pos == breakpoint_storage_.end() || pos->second.get() != bp) [[unlikely]]
+        return nullptr;
+    unwatch_dependencies(bp);
+    // remove it before after transfer the ownership
+    std::unique_ptr<DebugBreakPoint> res = std::move(pos->second);
+    breakpoint_storage_.erase(pos);
+    breakpoints_dirty_ = true;
+    auto &instances = breakpoint_index_[id];
+    std::erase(instances, bp);
+    if (instances.empty()) breakpoint_index_.erase(id);
+    return res;
+}
+
+void Scheduler::update_breakpoint_view() {
+    if (!breakpoints_dirty_) [[likely]]
+        return;
+    breakpoints_.clear();
+    breakpoints_.reserve(breakpoint_storage_.size());
+    for (auto const &[key, bp] : breakpoint_storage_) {
+        breakpoints_.emplace_back(bp.get());
     }
+    breakpoints_dirty_ = false;
+}
 
+std::vector<DebugBreakPoint *> Scheduler::create_next_breakpoints(uint32_t bp_id) {
+    // step breakpoints are validated once and reused, since stepping visits the same
+    // breakpoints over and over again
+    auto &step_bps = step_breakpoints_[bp_id];
+    if (step_bps.empty()) [[unlikely]] {
+        auto bp_info = db_->get_breakpoint(bp_id);
+        if (!bp_info) {
+            step_breakpoints_.erase(bp_id);
+            return {};
+        }
+        std::string cond = bp_info->condition.empty() ? "1" : bp_info->condition;
+        auto instance_name = db_->get_instance_name(*bp_info->instance_id);
+        auto const &namespaces = namespaces_.get_namespaces(instance_name);
+        step_bps.reserve(namespaces.size());
+        for (auto *ns : namespaces) {
+            auto &bp = step_bps.emplace_back(std::make_unique<DebugBreakPoint>());
+            bp->id = bp_id;
+            bp->instance_id = *bp_info->instance_id;
+            bp->ns_id = ns->id;
+            bp->enable_expr = std::make_unique<DebugExpression>(cond);
+            bp->filename = bp_info->filename;
+            bp->line_num = bp_info->line_num;
+            bp->column_num = bp_info->column_num;
+            util::validate_expr(ns->rtl.get(), db_, bp->enable_expr.get(), bp->id,
+                                bp->instance_id);
+        }
+    } else {
+        // only successful validations are reused. the instances stay in place since the
+        // debugger may still refer to them
+        for (auto &bp : step_bps) {
+            if (bp->enable_expr->correct()) [[likely]]
+                continue;
+            bp->enable_expr = std::make_unique<DebugExpression>(bp->enable_expr->expression());
+            util::validate_expr(namespaces_[bp->ns_id]->rtl.get(), db_, bp->enable_expr.get(),
+                                bp->id, bp->instance_id);
+        }
+    }
+
+    std::vector<DebugBreakPoint *> res;
+    res.reserve(step_bps.size());
+    for (auto &bp : step_bps) {
+        bp->evaluated = true;
+        res.emplace_back(bp.get());
+    }
     return res;
 }
 
-std::unique_ptr<DebugBreakPoint> Scheduler::remove_breakpoint(uint64_t bp_id,
-                                                              DebugBreakPoint::Type type) {
+std::vector<std::unique_ptr<DebugBreakPoint>> Scheduler::remove_breakpoint(
+    uint64_t bp_id, DebugBreakPoint::Type type) {
     // notice that removal doesn't need reordering
-    for (auto pos = breakpoints_.begin(); pos != breakpoints_.end(); pos++) {
-        if ((*pos)->id == bp_id) {
-            // erase the type first. if the remaining type is 0, then we completely erase the
-            // breakpoint
-            auto t = static_cast<uint32_t>((*pos)->type);
-            t &= ~(static_cast<uint32_t>(type));
-            if (t == 0) {
-                // remove it before after transfer the ownership
-                std::unique_ptr<DebugBreakPoint> res = std::move(*pos);
-                breakpoints_.erase(pos);
-                inserted_breakpoints_.erase(bp_id);
-                return res;
-            } else {
-                (*pos)->type = static_cast<DebugBreakPoint::Type>(t);
-            }
-            break;
+    auto pos = breakpoint_index_.find(bp_id);
+    if (pos == breakpoint_index_.end()) return {};
+    std::vector<std::unique_ptr<DebugBreakPoint>> res;
+    // copy since erasing changes the index
+    auto instances = pos->second;
+    for (auto *bp : instances) {
+        // erase the type first. if the remaining type is 0, then we completely erase the
+        // breakpoint
+        auto t = static_cast<uint32_t>(bp->type);
+        t &= ~(static_cast<uint32_t>(type));
+        if (t == 0) {
+            auto removed = erase_breakpoint(bp);
+            if (removed) res.emplace_back(std::move(removed));
+        } else {
+            bp->type = static_cast<DebugBreakPoint::Type>(t);
         }
     }
-    return nullptr;
+    return res;
 }
 
 void Scheduler::remove_assert_breakpoints() {
-    auto ids =
-        std::unordered_set<uint32_t>(inserted_breakpoints_.begin(), inserted_breakpoints_.end());
-    for (auto bp_id : ids) {
-        auto *bp = get_breakpoint(bp_id);
-        if (bp && bp->has_type_flag(DebugBreakPoint::Type::assert) && bp->evaluated) {
-            remove_breakpoint(bp_id, DebugBreakPoint::Type::assert);
+    std::vector<uint32_t> ids;
+    for (auto const &[key, bp] : breakpoint_storage_) {
+        if (bp->has_type_flag(DebugBreakPoint::Type::assert) && bp->evaluated) {
+            ids.emplace_back(bp->id);
         }
     }
+    for (auto bp_id : ids) {
+        remove_breakpoint(bp_id, DebugBreakPoint::Type::assert);
+    }
 }
 
-void clear_breakpoints(std::vector<std::unique_ptr<DebugBreakPoint>> &breakpoints) {
-    for (auto &bp : breakpoints) {
+void clear_breakpoints(
+    std::map<std::pair<uint64_t, uint64_t>, std::unique_ptr<DebugBreakPoint>> &breakpoints) {
+    for (auto &[key, bp] : breakpoints) {
         bp->evaluated = false;
     }
 }
 
-void Scheduler::start_breakpoint_evaluation() {
+void Scheduler::start_breakpoint_evaluation(std::optional<uint32_t> clock_domain) {
     // remove assertions first
     remove_assert_breakpoints();
     // unset all the breakpoints
-    clear_breakpoints(breakpoints_);
+    clear_breakpoints(breakpoint_storage_);
     current_breakpoint_id_ = std::nullopt;
+    current_time_ = simulation_time();
+    current_clock_domain_ = clock_domain;
 }
 
 void Scheduler::set_evaluation_mode(EvaluationMode mode) {
     if (evaluation_mode_ != mode) {
-        clear_breakpoints(breakpoints_);
+        clear_breakpoints(breakpoint_storage_);
+        // reverse modes rewind the simulation, so anything cached before is stale
+        for (auto &[key, bp] : breakpoint_storage_) {
+            bp->cached_result = std::nullopt;
+        }
         evaluation_mode_ = mode;
     }
 }
 
 void Scheduler::clear() {
-    inserted_breakpoints_.clear();
+    for (auto &[key, bp] : breakpoint_storage_) {
+        unwatch_dependencies(bp.get());
+    }
+    breakpoint_index_.clear();
+    breakpoint_storage_.clear();
     breakpoints_.clear();
+    breakpoints_dirty_ = false;
+    step_breakpoints_.clear();
 }
 
 // functions that compute the trigger values
-std::unordered_map<std::string, vpiHandle> compute_trigger_symbol(const BreakPoint &bp,
-                                                                  RTLSimulatorClient *rtl,
-                                                                  SymbolTableProvider *db) {
+void compute_trigger_symbol(const BreakPoint &bp, RTLSimulatorClient *rtl,
+                            SymbolTableProvider *db, DebugBreakPoint &debug_bp) {
     auto const &trigger_str = bp.trigger;
     auto tokens = util::get_tokens(trigger_str, " ");
-    std::unordered_map<std::string, vpiHandle> result;
-    if (!tokens.empty()) {
-        auto instance_name = db->get_instance_name(*bp.instance_id);
-        if (!instance_name) return {};
-        for (auto const &symbol : tokens) {
-            auto full_name = fmt::format("{0}.{1}", *instance_name, symbol);
-            auto *handle = rtl->get_handle(full_name);
-            if (!handle) {
-                return {};
-            }
-            result.emplace(symbol, handle);
+    if (tokens.empty()) return;
+    auto instance_name = db->get_instance_name(*bp.instance_id);
+    if (!instance_name) return;
+    std::vector<std::string> names;
+    std::vector<vpiHandle> handles;
+    for (auto const &symbol : tokens) {
+        if (std::find(names.begin(), names.end(), symbol) != names.end()) continue;
+        auto full_name = fmt::format("{0}.{1}", *instance_name, symbol);
+        auto *handle = rtl->get_handle(full_name);
+        if (!handle) {
+            return;
         }
+        names.emplace_back(symbol);
+        handles.emplace_back(handle);
     }
 
-    return result;
+    debug_bp.trigger_values.resize(handles.size());
+    debug_bp.trigger_names = std::move(names);
+    debug_bp.trigger_handles = std::move(handles);
+}
+
+void compute_condition(DebugBreakPoint &bp) {
+    auto value = bp.expr->correct() ? bp.expr->constant_value() : std::nullopt;
+    if (!value) {
+        bp.condition = DebugBreakPoint::Condition::dynamic;
+    } else {
+        bp.condition = *value ? DebugBreakPoint::Condition::always_true
+                              : DebugBreakPoint::Condition::always_false;
+    }
 }
 
 // NOLINTNEXTLINE
 DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const BreakPoint &db_bp,
                                            DebugBreakPoint::Type bp_type,
                                            const std::string &target_var, bool dry_run,
-                                           DebuggerNamespace *target_ns) {
+                                           DebuggerNamespace *target_ns,
+                                           const TimeWindow *time_window) {
     // add them to the eval vector
     std::string cond = "1";
     if (!db_bp.condition.empty()) cond = db_bp.condition;
@@ -352,7 +465,8 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
         cond.append(" && " + bp_info.condition);
     }
 
-    auto insert_bp = [bp_type, this, &db_bp, cond,
+    auto instance_name = db_->get_instance_name_from_bp(db_bp.id);
+    auto insert_bp = [bp_type, this, &db_bp, &instance_name, cond,
                       dry_run](DebuggerNamespace *ns) -> DebugBreakPoint * {
         auto *rtl = ns->rtl.get();
         auto bp = std::make_unique<DebugBreakPoint>();
@@ -365,8 +479,11 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
         bp->filename = db_bp.filename;
         bp->line_num = db_bp.line_num;
         bp->column_num = db_bp.column_num;
-        bp->trigger_symbols = compute_trigger_symbol(db_bp, rtl, db_);
+        compute_trigger_symbol(db_bp, rtl, db_, *bp);
         bp->type = bp_type;
+        if (instance_name) {
+            bp->clock_domain = compute_clock_domain(rtl->get_full_name(*instance_name));
+        }
         util::validate_expr(rtl, db_, bp->expr.get(), db_bp.id, *db_bp.instance_id);
         if (!bp->expr->correct()) [[unlikely]] {
             log_error("Unable to validate breakpoint expression: " + cond);
@@ -377,6 +494,10 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
             log_error("Unable to validate breakpoint expression: " + cond);
             return nullptr;
         }
+        compute_condition(*bp);
+        if (bp->condition == DebugBreakPoint::Condition::always_false) {
+            log_info(fmt::format("Breakpoint {0} condition is always false: {1}", db_bp.id, cond));
+        }
 
         if (dry_run) {
             // just need a memory holder
@@ -384,21 +505,28 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
             holder = std::move(bp);
             return holder.get();
         } else {
-            auto &ptr = breakpoints_.emplace_back(std::move(bp));
-            inserted_breakpoints_.emplace(db_bp.id);
+            intern_expressions(bp.get());
+            auto *ptr = insert_breakpoint(std::move(bp));
             log_info(
                 fmt::format("Breakpoint inserted into {0}:{1}", db_bp.filename, db_bp.line_num));
-            return ptr.get();
+            return ptr;
         }
     };
 
     std::lock_guard guard(breakpoint_lock_);
-    auto instance_name = db_->get_instance_name_from_bp(db_bp.id);
     auto const &namespaces = namespaces_.get_namespaces(instance_name);
 
     switch (bp_type) {
         case DebugBreakPoint::Type::normal: {
-            if (inserted_breakpoints_.find(db_bp.id) == inserted_breakpoints_.end()) {
+            // data breakpoints with the same id are kept as separate instances
+            std::vector<DebugBreakPoint *> existing;
+            if (auto pos = breakpoint_index_.find(db_bp.id); pos != breakpoint_index_.end()) {
+                std::copy_if(pos->second.begin(), pos->second.end(),
+                             std::back_inserter(existing), [](auto const *b) {
+                                 return b->has_type_flag(DebugBreakPoint::Type::normal);
+                             });
+            }
+            if (existing.empty()) {
                 DebugBreakPoint *p = nullptr;
                 for (auto *ns : namespaces) {
                     p = insert_bp(ns);
@@ -407,38 +535,42 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
                 return p;
             } else {
                 // update breakpoint entry
-                for (auto &b : breakpoints_) {
-                    if (db_bp.id == b->id) {
-                        b->expr = std::make_unique<DebugExpression>(cond);
-                        auto *ns = namespaces_[b->ns_id];
-                        auto *rtl = ns->rtl.get();
-                        util::validate_expr(rtl, db_, b->expr.get(), db_bp.id, *db_bp.instance_id);
-                        if (!b->expr->correct()) [[unlikely]] {
-                            log_error("Unable to validate breakpoint expression: " + cond);
-                        }
-                        // need to update the bp type flag
-                        b->type = static_cast<DebugBreakPoint::Type>(static_cast<int>(b->type) |
-                                                                     static_cast<int>(bp_type));
-                        return b.get();
+                for (auto *b : existing) {
+                    unwatch_dependencies(b);
+                    b->expr = std::make_unique<DebugExpression>(cond);
+                    auto *rtl = namespaces_[b->ns_id]->rtl.get();
+                    util::validate_expr(rtl, db_, b->expr.get(), db_bp.id, *db_bp.instance_id);
+                    if (!b->expr->correct()) [[unlikely]] {
+                        log_error("Unable to validate breakpoint expression: " + cond);
                     }
+                    compute_condition(*b);
+                    intern_expressions(b);
+                    watch_dependencies(b);
                 }
-                return nullptr;
+                return existing.front();
             }
         }
         case DebugBreakPoint::Type::data: {
             // we skip insertion if everything matches
-            for (auto const &b : breakpoints_) {
-                if (b->id == db_bp.id && b->has_type_flag(DebugBreakPoint::Type::data)) {
+            if (auto pos = breakpoint_index_.find(db_bp.id); pos != breakpoint_index_.end()) {
+                DebugBreakPoint *existing = nullptr;
+                for (auto *b : pos->second) {
                     // check if it's data breakpoint as well
-                    if (b->target_rtl_var_name == target_var && b->expr->expression() == cond) {
-                        // no need to insert
-                        return b.get();
+                    if (b->has_type_flag(DebugBreakPoint::Type::data) &&
+                        b->target_rtl_var_name == target_var && b->expr->expression() == cond) {
+                        if (time_window && !dry_run) b->time_window = *time_window;
+                        if (!existing) existing = b;
                     }
                 }
+                // no need to insert
+                if (existing) return existing;
             }
             DebugBreakPoint *data_bp = nullptr;
             for (auto *ns : namespaces) {
                 data_bp = insert_bp(ns);
+                if (!data_bp) return nullptr;
+                // only the instances of this data breakpoint, which shares its id with others
+                if (time_window) data_bp->time_window = *time_window;
                 auto *rtl = ns->rtl.get();
                 auto expr = DebugExpression(target_var);
                 util::validate_expr(rtl, db_, &expr, db_bp.id, *db_bp.instance_id);
@@ -447,7 +579,7 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
                     log_error("Unable to validate variable in data breakpoint: " + target_var);
                     return nullptr;
                 }
-                data_bp->full_rtl_handle = handles.begin()->second;
+                data_bp->full_rtl_handle = handles.front().handle;
                 data_bp->full_rtl_name = rtl->get_full_name(data_bp->full_rtl_handle);
                 data_bp->target_rtl_var_name = target_var;
             }
@@ -464,12 +596,14 @@ DebugBreakPoint *Scheduler::add_breakpoint(const BreakPoint &bp_info, const Brea
 
 DebugBreakPoint *Scheduler::add_data_breakpoint(const std::string &full_name,
                                                 const std::string &expression,
-                                                const BreakPoint &db_bp, bool dry_run) {
+                                                const BreakPoint &db_bp, bool dry_run,
+                                                const TimeWindow &time_window) {
     // we use the same add breakpoint function with different flags on
     BreakPoint bp;
     bp.condition = expression;
     // we allow duplicated breakpoints to be inserted here
-    auto *data_bp = add_breakpoint(bp, db_bp, DebugBreakPoint::Type::data, full_name, dry_run);
+    auto *data_bp = add_breakpoint(bp, db_bp, DebugBreakPoint::Type::data, full_name, dry_run,
+                                   nullptr, &time_window);
     return data_bp;
 }
 
@@ -482,59 +616,80 @@ void Scheduler::clear_data_breakpoints() {
     std::lock_guard guard(breakpoint_lock_);
     // if it has both data breakpoints and normal breakpoints, clear the flag
     // else remove this breakpoint
-    std::unordered_set<uint32_t> bps;
-    for (auto &bp : breakpoints_) {
+    for (auto &[key, bp] : breakpoint_storage_) {
         if (bp->has_type_flag(DebugBreakPoint::Type::data)) {
             if (bp->has_type_flag(DebugBreakPoint::Type::normal)) {
                 bp->type = DebugBreakPoint::Type::normal;
             } else {
-                // remove this breakpoint
-                bps.emplace(bp->id);
+                unwatch_dependencies(bp.get());
+                auto &instances = breakpoint_index_[bp->id];
+                std::erase(instances, bp.get());
+                if (instances.empty()) breakpoint_index_.erase(bp->id);
             }
         }
     }
-    for (auto id : bps) {
-        auto pos = std::find_if(breakpoints_.begin(), breakpoints_.end(),
-                                [id](auto const &bp) { return bp->id == id; });
-        if (pos != breakpoints_.end()) {
-            breakpoints_.erase(pos);
-            inserted_breakpoints_.erase(id);
-        }
-    }
+    // remove the rest in one pass
+    auto removed = std::erase_if(breakpoint_storage_, [](auto const &entry) {
+        return entry.second->has_type_flag(DebugBreakPoint::Type::data);
+    });
+    if (removed) breakpoints_dirty_ = true;
 }
 
-void Scheduler::reorder_breakpoints() {
+void Scheduler::remove_breakpoint(const BreakPoint &bp, DebugBreakPoint::Type type) {
     std::lock_guard guard(breakpoint_lock_);
-    // need to sort them by the ordering
-    // the easiest way is to sort them by their lookup table. assuming the number of
-    // breakpoints is relatively small, i.e. < 100, sorting can be efficient and less
-    // bug-prone
-    std::sort(breakpoints_.begin(), breakpoints_.end(),
-              [this](const auto &left, const auto &right) -> bool {
-                  return bp_ordering_table_.at(left->id) < bp_ordering_table_.at(right->id);
-              });
+    remove_breakpoint(bp.id, type);
 }
 
-void Scheduler::remove_breakpoint(const BreakPoint &bp, DebugBreakPoint::Type type) {
+void Scheduler::set_hit_condition(uint32_t bp_id, DebugBreakPoint::Type type,
+                                  const HitCountCondition &condition) {
     std::lock_guard guard(breakpoint_lock_);
-    remove_breakpoint(bp.id, type);
+    auto pos = breakpoint_index_.find(bp_id);
+    if (pos == breakpoint_index_.end()) return;
+    for (auto *bp : pos->second) {
+        if (!bp->has_type_flag(type)) continue;
+        bp->hit_condition = condition;
+        bp->hit_count = 0;
+    }
 }
 
-std::optional<uint64_t> Scheduler::remove_data_breakpoint(uint64_t bp_id) {
+void Scheduler::set_time_window(uint32_t bp_id, DebugBreakPoint::Type type,
+                                const TimeWindow &window) {
     std::lock_guard guard(breakpoint_lock_);
-    auto ptr = remove_breakpoint(bp_id, DebugBreakPoint::Type::data);
-    if (ptr) {
-        return ptr->watch_id;
-    } else {
-        return std::nullopt;
+    auto pos = breakpoint_index_.find(bp_id);
+    if (pos == breakpoint_index_.end()) return;
+    for (auto *bp : pos->second) {
+        if (bp->has_type_flag(type)) bp->time_window = window;
     }
 }
 
+std::vector<std::pair<uint32_t, uint64_t>> Scheduler::remove_data_breakpoint(uint64_t bp_id) {
+    std::lock_guard guard(breakpoint_lock_);
+    auto removed = remove_breakpoint(bp_id, DebugBreakPoint::Type::data);
+    // one per namespace, and possibly one per variable
+    std::vector<std::pair<uint32_t, uint64_t>> watches;
+    for (auto const &bp : removed) {
+        auto watch = std::make_pair(bp->ns_id, bp->watch_id);
+        if (std::find(watches.begin(), watches.end(), watch) == watches.end()) {
+            watches.emplace_back(watch);
+        }
+    }
+    // data breakpoints on the same signal share the watch
+    std::erase_if(watches, [this](auto const &watch) {
+        return std::any_of(breakpoint_storage_.begin(), breakpoint_storage_.end(),
+                           [&watch](auto const &entry) {
+                               auto const &bp = entry.second;
+                               return bp->has_type_flag(DebugBreakPoint::Type::data) &&
+                                      bp->ns_id == watch.first && bp->watch_id == watch.second;
+                           });
+    });
+    return watches;
+}
+
 std::vector<const DebugBreakPoint *> Scheduler::get_current_breakpoints() {
     std::vector<const DebugBreakPoint *> bps;
     std::lock_guard guard(breakpoint_lock_);
-    bps.reserve(breakpoints_.size());
-    for (auto const &bp : breakpoints_) {
+    bps.reserve(breakpoint_storage_.size());
+    for (auto const &[key, bp] : breakpoint_storage_) {
         bps.emplace_back(bp.get());
     }
     return bps;
@@ -545,6 +700,169 @@ bool Scheduler::breakpoint_only() const {
            evaluation_mode_ == EvaluationMode::ReverseBreakpointOnly;
 }
 
+PLI_INT32 on_signal_dependency_changed(p_cb_data cb_data) {
+    auto *dependency = reinterpret_cast<SignalDependency *>(cb_data->user_data);
+    dependency->scheduler->on_dependency_changed(dependency);
+    return 0;
+}
+
+void Scheduler::set_change_driven(bool enable) {
+    std::lock_guard guard(breakpoint_lock_);
+    if (change_driven_ == enable) [[likely]]
+        return;
+    change_driven_ = enable;
+    for (auto &[key, bp] : breakpoint_storage_) {
+        if (enable) {
+            watch_dependencies(bp.get());
+        } else {
+            unwatch_dependencies(bp.get());
+        }
+    }
+}
+
+void Scheduler::on_dependency_changed(SignalDependency *dependency) {
+    std::lock_guard guard(breakpoint_lock_);
+    for (auto *bp : dependency->breakpoints) {
+        bp->cached_result = std::nullopt;
+    }
+}
+
+void Scheduler::clear_cached_results() {
+    std::lock_guard guard(breakpoint_lock_);
+    for (auto &[key, bp] : breakpoint_storage_) {
+        bp->cached_result = std::nullopt;
+    }
+}
+
+void Scheduler::next_expression_epoch() {
+    auto time = simulation_time();
+    std::lock_guard guard(breakpoint_lock_);
+    for (auto &[ns_id, graph] : expression_graphs_) {
+        graph->next_epoch(time);
+    }
+}
+
+void Scheduler::intern_expressions(DebugBreakPoint *bp) {
+    auto &graph = expression_graphs_[bp->ns_id];
+    if (!graph) graph = std::make_unique<ExpressionGraph>();
+    bp->expr_graph = graph.get();
+    bp->expr_node = graph->intern(*bp->expr, bp->instance_id);
+    bp->enable_expr_node = graph->intern(*bp->enable_expr, bp->instance_id);
+}
+
+void Scheduler::watch_dependencies(DebugBreakPoint *bp) {
+    if (!change_driven_ || !bp->expr->correct() || bp->change_driven) return;
+    auto *rtl = namespaces_[bp->ns_id]->rtl.get();
+    for (auto const &binding : bp->expr->get_resolved_symbol_handles()) {
+        using Kind = DebugExpression::SymbolBinding::Kind;
+        if (binding.kind == Kind::instance) continue;
+        if (binding.kind == Kind::time) {
+            // changes every cycle
+            unwatch_dependencies(bp);
+            return;
+        }
+        auto &dependency = dependencies_[binding.handle];
+        if (!dependency) {
+            auto name = fmt::format("Dependency {0}", rtl->get_full_name(binding.handle));
+            dependency = std::make_unique<SignalDependency>(
+                SignalDependency{.scheduler = this, .rtl = rtl, .callback_name = name});
+            auto const *cb = rtl->add_call_back(name, cbValueChange, on_signal_dependency_changed,
+                                                binding.handle, dependency.get());
+            if (!cb) {
+                // not every simulator supports value change callbacks on every signal
+                dependencies_.erase(binding.handle);
+                unwatch_dependencies(bp);
+                return;
+            }
+        }
+        dependency->breakpoints.emplace_back(bp);
+        bp->dependencies.emplace_back(binding.handle);
+    }
+    bp->change_driven = true;
+    bp->cached_result = std::nullopt;
+}
+
+void Scheduler::unwatch_dependencies(DebugBreakPoint *bp) {
+    for (auto *handle : bp->dependencies) {
+        auto pos = dependencies_.find(handle);
+        if (pos == dependencies_.end()) [[unlikely]]
+            continue;
+        auto &dependency = *pos->second;
+        std::erase(dependency.breakpoints, bp);
+        if (dependency.breakpoints.empty()) {
+            dependency.rtl->remove_call_back(dependency.callback_name);
+            dependencies_.erase(pos);
+        }
+    }
+    bp->dependencies.clear();
+    bp->change_driven = false;
+    bp->cached_result = std::nullopt;
+}
+
+bool Scheduler::idle() {
+    std::lock_guard guard(breakpoint_lock_);
+    if (evaluation_mode_ == EvaluationMode::StepOver ||
+        evaluation_mode_ == EvaluationMode::StepBack) {
+        return false;
+    }
+    if (breakpoint_storage_.empty()) return true;
+    // closed windows can only reopen when the simulation goes backward
+    if (evaluation_mode_ != EvaluationMode::BreakPointOnly) return false;
+    auto time = simulation_time();
+    return std::all_of(breakpoint_storage_.begin(), breakpoint_storage_.end(),
+                       [time](auto const &entry) {
+                           return entry.second->time_window.closed(time);
+                       });
+}
+
+bool Scheduler::outside_time_windows() {
+    std::lock_guard guard(breakpoint_lock_);
+    if (evaluation_mode_ != EvaluationMode::BreakPointOnly &&
+        evaluation_mode_ != EvaluationMode::ReverseBreakpointOnly) {
+        return false;
+    }
+    auto time = simulation_time();
+    return std::none_of(breakpoint_storage_.begin(), breakpoint_storage_.end(),
+                        [time](auto const &entry) {
+                            return entry.second->time_window.contains(time);
+                        });
+}
+
+std::optional<uint32_t> Scheduler::compute_clock_domain(const std::string &instance_name) const {
+    // a single clock drives everything
+    if (clock_names_.size() < 2) return std::nullopt;
+    // the instance belongs to the clock declared in its closest enclosing scope. if several
+    // clocks are declared in that scope we can't tell which one is used
+    std::optional<uint32_t> result;
+    uint64_t scope_size = 0;
+    bool ambiguous = false;
+    for (auto i = 0u; i < clock_names_.size(); i++) {
+        auto const &clock_name = clock_names_[i];
+        auto pos = clock_name.rfind('.');
+        auto scope = pos == std::string::npos ? std::string_view()
+                                              : std::string_view(clock_name).substr(0, pos);
+        if (!scope.empty() &&
+            !(instance_name == scope ||
+              (instance_name.starts_with(scope) && instance_name.size() > scope.size() &&
+               instance_name[scope.size()] == '.'))) {
+            continue;
+        }
+        if (!result || scope.size() > scope_size) {
+            result = i;
+            scope_size = scope.size();
+            ambiguous = false;
+        } else if (scope.size() == scope_size) {
+            ambiguous = true;
+        }
+    }
+    return ambiguous ? std::nullopt : result;
+}
+
+uint64_t Scheduler::simulation_time() const {
+    auto *rtl = namespaces_.default_rtl();
+    return rtl ? rtl->get_simulation_time() : 0;
+}
+
 void Scheduler::log_error(const std::string &msg) { log::log(log::log_level::error, msg); }
 
 void Scheduler::log_info(const std::string &msg) const {
@@ -555,7 +873,7 @@ void Scheduler::log_info(const std::string &msg) const {
 
 void Scheduler::scan_breakpoints(uint64_t ref_index, bool forward,
                                  std::vector<DebugBreakPoint *> &result) {
-    auto const &ref_bp = breakpoints_[ref_index];
+    auto const *ref_bp = breakpoints_[ref_index];
     auto const &target_expr = ref_bp->enable_expr->expression();
 
     // notice that if the reference is a data breakpoint, we're done here, since we only allow
@@ -569,7 +887,7 @@ void Scheduler::scan_breakpoints(uint64_t ref_index, bool forward,
     // - different instance id
 
     auto match = [&](uint64_t i) -> bool {
-        auto const &next_bp = breakpoints_[i];
+        auto *next_bp = breakpoints_[i];
         // if fn/ln/cn tuple doesn't match, stop
         // reorder the comparison in a way that exploits short circuit
         if (next_bp->line_num != ref_bp->line_num || next_bp->filename != ref_bp->filename ||
@@ -581,9 +899,9 @@ void Scheduler::scan_breakpoints(uint64_t ref_index, bool forward,
             return true;
         }
         // same enable expression but different instance id
-        if (next_bp->instance_id != ref_bp->instance_id &&
+        if (next_bp->instance_id != ref_bp->instance_id && !skip_evaluation(*next_bp) &&
             next_bp->enable_expr->expression() == target_expr) {
-            result.emplace_back(next_bp.get());
+            result.emplace_back(next_bp);
         }
         return true;
     };
@@ -621,7 +939,9 @@ void validate_expr(RTLSimulatorClient *rtl, SymbolTableProvider *db, DebugExpres
                                                                        instance_var_name};
     for (auto const &symbol : required_symbols) {
         if (predefined_symbols.find(symbol) != predefined_symbols.end()) [[unlikely]] {
-            expr->set_resolved_symbol_handle(symbol, nullptr);
+            auto kind = symbol == time_var_name ? DebugExpression::SymbolBinding::Kind::time
+                                                : DebugExpression::SymbolBinding::Kind::instance;
+            expr->set_resolved_symbol_handle(symbol, nullptr, kind);
             continue;
         }
         std::optional<std::string> name;
@@ -661,7 +981,10 @@ void validate_expr(RTLSimulatorClient *rtl, SymbolTableProvider *db, DebugExpres
             return;
         }
         auto *handle = rtl->get_handle(full_name);
-        expr->set_resolved_symbol_handle(symbol, handle);
+        auto width = rtl->get_signal_width(handle);
+        auto kind = width && *width > 64 ? DebugExpression::SymbolBinding::Kind::wide_signal
+                                         : DebugExpression::SymbolBinding::Kind::signal;
+        expr->set_resolved_symbol_handle(symbol, handle, kind, width ? *width : 0);
     }
 }
 #ifndef __clang__
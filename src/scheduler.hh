@@ -1,9 +1,11 @@
 #ifndef HGDB_SCHEDULER_HH
 #define HGDB_SCHEDULER_HH
 
+#include <map>
 #include <mutex>
 
 #include "eval.hh"
+#include "proto.hh"
 #include "rtl.hh"
 #include "symbol.hh"
 
@@ -11,9 +13,13 @@ namespace hgdb {
 
 struct DebuggerNamespaceManager;
 struct DebuggerNamespace;
+class Scheduler;
+class SchedulerTestFriend;
 
 struct DebugBreakPoint {
     enum class Type { normal = 1 << 0, data = 1 << 1, assert = 1 << 2 };
+    // breakpoint condition after static values are folded in
+    enum class Condition { dynamic, always_true, always_false };
     uint32_t id = 0;
     uint32_t instance_id = 0;
     std::unique_ptr<DebugExpression> expr;
@@ -22,13 +28,39 @@ struct DebugBreakPoint {
     uint32_t line_num = 0;
     uint32_t column_num = 0;
     // this is to match with the always_comb semantics
-    // first table stores the overall symbols that triggers
-    // second table stores the seen value
-    std::unordered_map<std::string, vpiHandle> trigger_symbols;
-    std::unordered_map<std::string, int64_t> trigger_values;
+    // trigger symbols are stored as parallel arrays so that edge detection can compare all of
+    // them in one sweep. names are only kept for error reporting
+    std::vector<std::string> trigger_names;
+    std::vector<vpiHandle> trigger_handles;
+    std::vector<int64_t> trigger_values;
+    // whether trigger_values holds the values seen in the last evaluation
+    bool trigger_values_valid = false;
 
     // used to mimic software behavior
     bool evaluated = false;
+    // insertion order among instances with the same execution order
+    uint64_t sequence = 0;
+    // always false breakpoints are skipped by the scheduler
+    Condition condition = Condition::dynamic;
+    // hits are counted per instance. only qualifying hits are reported
+    HitCountCondition hit_condition;
+    uint64_t hit_count = 0;
+    // breakpoints outside their simulation time window are not scheduled
+    TimeWindow time_window;
+    // index of the clock that drives the instance. breakpoints without a known clock domain are
+    // evaluated at the edges of every clock
+    std::optional<uint32_t> clock_domain;
+
+    // change-driven evaluation. the last result of expr stays valid until one of the signals
+    // it depends on changes, which is reported through value change callbacks
+    bool change_driven = false;
+    std::optional<int64_t> cached_result;
+    std::vector<vpiHandle> dependencies;
+
+    // nodes of expr and enable_expr in the namespace expression graph, if they can be interned
+    ExpressionGraph *expr_graph = nullptr;
+    std::optional<uint32_t> expr_node;
+    std::optional<uint32_t> enable_expr_node;
 
     // used for data breakpoint
     Type type = Type::normal;
@@ -45,10 +77,20 @@ struct DebugBreakPoint {
     }
 };
 
+// a signal referenced by breakpoint conditions, together with the breakpoints that need to be
+// re-evaluated when its value changes
+struct SignalDependency {
+    Scheduler *scheduler;
+    RTLSimulatorClient *rtl;
+    std::string callback_name;
+    std::vector<DebugBreakPoint *> breakpoints;
+};
+
 class Scheduler {
 public:
     Scheduler(DebuggerNamespaceManager &namespaces, SymbolTableProvider *db,
               const bool &single_thread_mode, const bool &log_enabled);
+    ~Scheduler();
     enum class EvaluationMode { BreakPointOnly, StepOver, StepBack, ReverseBreakpointOnly, None };
     std::vector<DebugBreakPoint *> next_breakpoints();
     std::vector<DebugBreakPoint *> next_step_over_breakpoints();
@@ -56,7 +98,8 @@ public:
     std::vector<DebugBreakPoint *> next_step_back_breakpoints();
     std::vector<DebugBreakPoint *> next_reverse_breakpoints();
     DebugBreakPoint *get_breakpoint(uint32_t id) const;
-    void start_breakpoint_evaluation();
+    // only breakpoints in the given clock domain are scheduled, if specified
+    void start_breakpoint_evaluation(std::optional<uint32_t> clock_domain = std::nullopt);
 
     // change scheduling semantics
     void set_evaluation_mode(EvaluationMode mode);
@@ -66,38 +109,77 @@ public:
     DebugBreakPoint *add_breakpoint(const BreakPoint &bp_info, const BreakPoint &db_bp,
                                     DebugBreakPoint::Type bp_type = DebugBreakPoint::Type::normal,
                                     const std::string &target_var = "", bool dry_run = false,
-                                    DebuggerNamespace *target_ns = nullptr);
-    void reorder_breakpoints();
+                                    DebuggerNamespace *target_ns = nullptr,
+                                    const TimeWindow *time_window = nullptr);
     void remove_breakpoint(const BreakPoint &bp, DebugBreakPoint::Type type);
+    // data breakpoints share ids with normal breakpoints, so only instances of the given type
+    // are changed
+    void set_hit_condition(uint32_t bp_id, DebugBreakPoint::Type type,
+                           const HitCountCondition &condition);
+    void set_time_window(uint32_t bp_id, DebugBreakPoint::Type type, const TimeWindow &window);
     std::vector<const DebugBreakPoint *> get_current_breakpoints();
     DebugBreakPoint *add_data_breakpoint(const std::string &full_name,
                                          const std::string &expression, const BreakPoint &db_bp,
-                                         bool dry_run);
+                                         bool dry_run, const TimeWindow &time_window = {});
     DebugBreakPoint *add_assert_breakpoint(DebuggerNamespace *ns, const BreakPoint &db_bp);
     void clear_data_breakpoints();
-    // also return associated monitor id, if any
-    std::optional<uint64_t> remove_data_breakpoint(uint64_t bp_id);
+    // returns the (namespace id, monitor id) pairs that are no longer used by any data
+    // breakpoint, so that the caller can stop watching them
+    std::vector<std::pair<uint32_t, uint64_t>> remove_data_breakpoint(uint64_t bp_id);
 
     // breakpoint mode
     bool breakpoint_only() const;
+    // results cached by change-driven evaluation are only used while the simulation moves
+    // forward. rewinding changes values without firing any value change callback
+    bool use_cached_results() const { return evaluation_mode_ == EvaluationMode::BreakPointOnly; }
+    // needed whenever the simulation time jumps
+    void clear_cached_results();
+    // true if nothing needs to be evaluated at clock edges
+    bool idle();
+    // true if no breakpoint is inside its time window at the current simulation time
+    bool outside_time_windows();
 
     [[nodiscard]] const std::vector<vpiHandle> &clock_handles() const { return clock_handles_; }
+    // clock domains are indexed by the position in this list
+    [[nodiscard]] const std::vector<std::string> &clock_names() const { return clock_names_; }
+
+    // change-driven evaluation
+    void set_change_driven(bool enable);
+    void on_dependency_changed(SignalDependency *dependency);
+
+    // invalidate values memoized by the expression graphs
+    void next_expression_epoch();
 
 private:
     DebuggerNamespaceManager &namespaces_;
     std::optional<uint32_t> current_breakpoint_id_;
 
     EvaluationMode evaluation_mode_ = EvaluationMode::BreakPointOnly;
-
-    std::vector<std::unique_ptr<DebugBreakPoint>> breakpoints_;
-    std::unordered_set<uint32_t> inserted_breakpoints_;
+    // simulation time of the current evaluation, used to check breakpoint time windows
+    uint64_t current_time_ = 0;
+    // clock domain of the current evaluation
+    std::optional<uint32_t> current_clock_domain_;
+
+    // breakpoints are owned by an ordered map keyed by (execution order, sequence), so that
+    // inserting or removing one is logarithmic. evaluation walks breakpoints_, a contiguous
+    // view in the same order that is only rebuilt when the next evaluation needs it, i.e. once
+    // per batch of changes. breakpoint_index_ maps a breakpoint id to its instances across
+    // namespaces
+    std::map<std::pair<uint64_t, uint64_t>, std::unique_ptr<DebugBreakPoint>>
+        breakpoint_storage_;
+    std::vector<DebugBreakPoint *> breakpoints_;
+    bool breakpoints_dirty_ = false;
+    uint64_t next_sequence_ = 0;
+    std::unordered_map<uint32_t, std::vector<DebugBreakPoint *>> breakpoint_index_;
     // look up table for ordering of breakpoints
     std::unordered_map<uint32_t, uint64_t> bp_ordering_table_;
     std::vector<uint32_t> bp_ordering_;
     // need to ensure there is no concurrent modification
     std::mutex breakpoint_lock_;
-    // holder for step over breakpoint, not used for normal purpose
-    std::vector<DebugBreakPoint> next_temp_breakpoints_;
+    // validated breakpoints used for step over and step back, one per namespace. not used for
+    // normal purpose
+    std::unordered_map<uint32_t, std::vector<std::unique_ptr<DebugBreakPoint>>>
+        step_breakpoints_;
 
     // get it from the debugger. no ownership
     SymbolTableProvider *db_;
@@ -108,10 +190,31 @@ private:
 
     // cache clock handles as well
     std::vector<vpiHandle> clock_handles_;
-
-    std::vector<DebugBreakPoint *> create_next_breakpoints(
-        const std::optional<BreakPoint> &bp_info);
-    std::unique_ptr<DebugBreakPoint> remove_breakpoint(uint64_t bp_id, DebugBreakPoint::Type type);
+    std::vector<std::string> clock_names_;
+
+    // reverse index from signals to the breakpoints that read them
+    bool change_driven_ = false;
+    std::unordered_map<vpiHandle, std::unique_ptr<SignalDependency>> dependencies_;
+
+    // breakpoint conditions are interned into one expression graph per namespace. graphs are
+    // never removed since breakpoints hold raw pointers into them
+    std::unordered_map<uint32_t, std::unique_ptr<ExpressionGraph>> expression_graphs_;
+
+    std::vector<DebugBreakPoint *> create_next_breakpoints(uint32_t bp_id);
+    std::vector<std::unique_ptr<DebugBreakPoint>> remove_breakpoint(uint64_t bp_id,
+                                                                    DebugBreakPoint::Type type);
+    [[nodiscard]] uint64_t execution_order(uint32_t bp_id) const;
+    [[nodiscard]] uint64_t simulation_time() const;
+    [[nodiscard]] bool skip_evaluation(const DebugBreakPoint &bp) const;
+    [[nodiscard]] std::optional<uint32_t> compute_clock_domain(
+        const std::string &instance_name) const;
+    DebugBreakPoint *insert_breakpoint(std::unique_ptr<DebugBreakPoint> bp);
+    std::unique_ptr<DebugBreakPoint> erase_breakpoint(DebugBreakPoint *bp);
+    // needs breakpoint_lock_
+    void update_breakpoint_view();
+    void watch_dependencies(DebugBreakPoint *bp);
+    void unwatch_dependencies(DebugBreakPoint *bp);
+    void intern_expressions(DebugBreakPoint *bp);
     void remove_assert_breakpoints();
 
     // log
@@ -120,6 +223,10 @@ private:
 
     // scanning nearby breakpoints for multi-thread mode
     void scan_breakpoints(uint64_t ref_index, bool forward, std::vector<DebugBreakPoint *> &result);
+
+    // test related
+public:
+    friend class SchedulerTestFriend;
 };
 
 namespace util {
@@ -0,0 +1,75 @@
+#include "snapshot.hh"
+
+namespace hgdb {
+
+SignalValueSnapshot::Table::Table(uint64_t capacity)
+    : mask(capacity - 1), entries(std::make_unique<Entry[]>(capacity)) {}
+
+SignalValueSnapshot::SignalValueSnapshot() {
+    tables_.emplace_back(std::make_unique<Table>(initial_capacity));
+    table_.store(tables_.back().get());
+}
+
+void SignalValueSnapshot::next_epoch() {
+    epoch_.fetch_add(1, std::memory_order_acq_rel);
+    if (grow_.load(std::memory_order_relaxed)) [[unlikely]] {
+        // every value is stale now, so no need to rehash anything
+        auto capacity = (table_.load()->mask + 1) * 4;
+        tables_.emplace_back(std::make_unique<Table>(capacity));
+        table_.store(tables_.back().get(), std::memory_order_release);
+        grow_.store(false, std::memory_order_relaxed);
+    }
+}
+
+std::optional<int64_t> SignalValueSnapshot::get(vpiHandle handle, uint64_t epoch) const {
+    auto *entry = find(table_.load(std::memory_order_acquire), handle, false);
+    if (!entry) return std::nullopt;
+    if (entry->epoch.load(std::memory_order_acquire) != epoch) return std::nullopt;
+    return entry->value.load(std::memory_order_relaxed);
+}
+
+void SignalValueSnapshot::set(vpiHandle handle, int64_t value, uint64_t epoch) {
+    auto *entry = find(table_.load(std::memory_order_acquire), handle, true);
+    if (!entry) [[unlikely]]
+        return;
+    entry->value.store(value, std::memory_order_relaxed);
+    entry->epoch.store(epoch, std::memory_order_release);
+}
+
+void SignalValueSnapshot::invalidate(vpiHandle handle) {
+    auto *entry = find(table_.load(std::memory_order_acquire), handle, false);
+    if (entry) entry->epoch.store(0, std::memory_order_release);
+}
+
+SignalValueSnapshot::Entry *SignalValueSnapshot::find(Table *table, vpiHandle handle,
+                                                      bool insert) const {
+    if (!handle) [[unlikely]]
+        return nullptr;
+    // fibonacci hashing, since handles are usually aligned pointers
+    auto hash = reinterpret_cast<uint64_t>(handle) * 0x9E3779B97F4A7C15ull;
+    hash ^= hash >> 32;
+    auto capacity = table->mask + 1;
+    for (uint64_t i = 0; i < capacity; i++) {
+        auto &entry = table->entries[(hash + i) & table->mask];
+        auto *key = entry.handle.load(std::memory_order_acquire);
+        if (key == handle) return &entry;
+        if (key) continue;
+        if (!insert) return nullptr;
+        // keep the load factor under 1/2 so probing stays short
+        if (table->size.load(std::memory_order_relaxed) >= capacity / 2) {
+            grow_.store(true, std::memory_order_relaxed);
+            return nullptr;
+        }
+        vpiHandle expected = nullptr;
+        if (entry.handle.compare_exchange_strong(expected, handle, std::memory_order_acq_rel)) {
+            table->size.fetch_add(1, std::memory_order_relaxed);
+            return &entry;
+        } else if (expected == handle) {
+            // someone else inserted the same handle
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace hgdb
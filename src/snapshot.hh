@@ -0,0 +1,58 @@
+#ifndef HGDB_SNAPSHOT_HH
+#define HGDB_SNAPSHOT_HH
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "vpi_user.h"
+
+namespace hgdb {
+
+// per-cycle signal value snapshot keyed by vpiHandle.
+// entries are stamped with the epoch they were read in, so bumping the epoch invalidates the
+// whole snapshot at once. reads and writes are lock-free and can be issued from any evaluator
+// thread. the table only grows inside next_epoch(), which has to be called from the simulator
+// thread
+class SignalValueSnapshot {
+public:
+    SignalValueSnapshot();
+
+    [[nodiscard]] uint64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+    void next_epoch();
+
+    // epoch has to be obtained before the value is read from the simulator
+    [[nodiscard]] std::optional<int64_t> get(vpiHandle handle, uint64_t epoch) const;
+    void set(vpiHandle handle, int64_t value, uint64_t epoch);
+    void invalidate(vpiHandle handle);
+
+private:
+    struct Entry {
+        std::atomic<vpiHandle> handle = nullptr;
+        std::atomic<uint64_t> epoch = 0;
+        std::atomic<int64_t> value = 0;
+    };
+
+    struct Table {
+        explicit Table(uint64_t capacity);
+        uint64_t mask;
+        std::unique_ptr<Entry[]> entries;
+        std::atomic<uint64_t> size = 0;
+    };
+
+    std::atomic<Table *> table_;
+    std::atomic<uint64_t> epoch_ = 1;
+    // set when the table is too full to take new handles
+    mutable std::atomic<bool> grow_ = false;
+    // retired tables are kept alive since concurrent readers may still hold them
+    std::vector<std::unique_ptr<Table>> tables_;
+
+    static constexpr uint64_t initial_capacity = 1024;
+
+    [[nodiscard]] Entry *find(Table *table, vpiHandle handle, bool insert) const;
+};
+
+}  // namespace hgdb
+
+#endif  // HGDB_SNAPSHOT_HH
@@ -1,5 +1,7 @@
 #include "thread.hh"
 
+#include <algorithm>
+
 namespace hgdb {
 
 void RuntimeLock::wait() {
@@ -18,4 +20,91 @@ void RuntimeLock::ready() {
     }
 }
 
-}  // namespace hgdb
\ No newline at end of file
+ThreadPool::ThreadPool(uint32_t num_workers)
+    : num_workers_(num_workers == 0 ? 1 : num_workers),
+      queues_(std::make_unique<WorkQueue[]>(num_workers_)) {
+    threads_.reserve(num_workers_ - 1);
+    for (auto i = 1u; i < num_workers_; i++) {
+        threads_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(m_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto &t : threads_) t.join();
+}
+
+void ThreadPool::parallel_for(uint64_t size, uint64_t batch_size,
+                              const std::function<void(uint64_t, uint64_t)> &func) {
+    if (size == 0) return;
+    if (batch_size == 0) batch_size = 1;
+    auto num_batches = (size + batch_size - 1) / batch_size;
+    if (num_workers_ == 1 || num_batches == 1) {
+        func(0, size);
+        return;
+    }
+
+    // distribute batches evenly. leftovers will be stolen by whoever finishes first
+    for (auto i = 0u; i < num_workers_; i++) {
+        queues_[i].next.store(num_batches * i / num_workers_, std::memory_order_relaxed);
+        queues_[i].end = num_batches * (i + 1) / num_workers_;
+    }
+
+    {
+        std::lock_guard guard(m_);
+        task_ = &func;
+        task_size_ = size;
+        batch_size_ = batch_size;
+        pending_ = num_workers_ - 1;
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    run_batches(0);
+
+    std::unique_lock lock(m_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::worker_loop(uint32_t id) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock(m_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+            if (stop_) return;
+            seen_generation = generation_;
+        }
+
+        run_batches(id);
+
+        bool done;
+        {
+            std::lock_guard guard(m_);
+            done = --pending_ == 0;
+        }
+        if (done) done_cv_.notify_one();
+    }
+}
+
+void ThreadPool::run_batches(uint32_t id) {
+    auto const &func = *task_;
+    // start with our own queue, then steal from the others
+    for (auto i = 0u; i < num_workers_; i++) {
+        auto &queue = queues_[(id + i) % num_workers_];
+        while (true) {
+            auto batch = queue.next.fetch_add(1, std::memory_order_relaxed);
+            if (batch >= queue.end) break;
+            auto start = batch * batch_size_;
+            auto end = std::min(start + batch_size_, task_size_);
+            func(start, end);
+        }
+    }
+}
+
+}  // namespace hgdb
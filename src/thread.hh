@@ -3,7 +3,11 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace hgdb {
 
@@ -19,6 +23,50 @@ private:
     std::condition_variable cv_;
 };
 
+// long-lived worker pool used to evaluate breakpoints in parallel. the calling thread always
+// participates as worker 0. work is split into batches and each worker owns a contiguous run of
+// batches; once a worker drains its own run it steals batches from the others
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t num_workers);
+    ~ThreadPool();
+
+    [[nodiscard]] uint32_t size() const { return num_workers_; }
+    // calls func(start, end) over [0, size) in chunks of at most batch_size.
+    // blocks until all the chunks are processed
+    void parallel_for(uint64_t size, uint64_t batch_size,
+                      const std::function<void(uint64_t, uint64_t)> &func);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+private:
+    // padded to avoid false sharing between workers
+    struct alignas(64) WorkQueue {
+        std::atomic<uint64_t> next = 0;
+        uint64_t end = 0;
+    };
+
+    uint32_t num_workers_;
+    std::vector<std::thread> threads_;
+    std::unique_ptr<WorkQueue[]> queues_;
+
+    std::mutex m_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    uint32_t pending_ = 0;
+    bool stop_ = false;
+
+    // current task
+    const std::function<void(uint64_t, uint64_t)> *task_ = nullptr;
+    uint64_t task_size_ = 0;
+    uint64_t batch_size_ = 0;
+
+    void worker_loop(uint32_t id);
+    void run_batches(uint32_t id);
+};
+
 }  // namespace hgdb
 
 #endif  // HGDB_THREAD_HH
@@ -0,0 +1,123 @@
+#include "wide.hh"
+
+#include "fmt/format.h"
+
+namespace hgdb {
+
+__extension__ using uint128_t = unsigned __int128;
+
+WideValue::WideValue(int64_t value) {
+    words.fill(value < 0 ? ~0ull : 0);
+    words[0] = static_cast<uint64_t>(value);
+}
+
+WideValue WideValue::zero_extend(int64_t value, uint32_t width) {
+    WideValue result;
+    auto bits = static_cast<uint64_t>(value);
+    result.words[0] = width > 0 && width < 64 ? bits & ((1ull << width) - 1) : bits;
+    return result;
+}
+
+bool WideValue::zero() const {
+    uint64_t bits = 0;
+    for (auto word : words) bits |= word;
+    return bits == 0;
+}
+
+std::optional<int64_t> WideValue::narrow() const {
+    auto const extension = static_cast<int64_t>(words[0]) < 0 ? ~0ull : 0;
+    for (auto i = 1u; i < num_words; i++) {
+        if (words[i] != extension) return std::nullopt;
+    }
+    return static_cast<int64_t>(words[0]);
+}
+
+std::string WideValue::hex_str() const {
+    auto top = num_words - 1;
+    while (top > 0 && !words[top]) top--;
+    std::string result = fmt::format("0x{0:X}", words[top]);
+    for (auto i = top; i > 0; i--) {
+        result.append(fmt::format("{0:016X}", words[i - 1]));
+    }
+    return result;
+}
+
+namespace wide {
+
+void add(const WideValue &left, const WideValue &right, WideValue &result) {
+    uint64_t carry = 0;
+    for (auto i = 0u; i < WideValue::num_words; i++) {
+        auto sum = static_cast<uint128_t>(left.words[i]) + right.words[i] + carry;
+        result.words[i] = static_cast<uint64_t>(sum);
+        carry = static_cast<uint64_t>(sum >> 64u);
+    }
+}
+
+void sub(const WideValue &left, const WideValue &right, WideValue &result) {
+    uint64_t borrow = 0;
+    for (auto i = 0u; i < WideValue::num_words; i++) {
+        auto l = left.words[i], r = right.words[i];
+        result.words[i] = l - r - borrow;
+        borrow = (l < r) || (l == r && borrow);
+    }
+}
+
+void mul(const WideValue &left, const WideValue &right, WideValue &result) {
+    // schoolbook multiplication truncated to the capacity. result may alias the operands
+    WideValue product;
+    for (auto i = 0u; i < WideValue::num_words; i++) {
+        if (!left.words[i]) continue;
+        uint64_t carry = 0;
+        for (auto j = 0u; i + j < WideValue::num_words; j++) {
+            auto value = static_cast<uint128_t>(left.words[i]) * right.words[j] +
+                         product.words[i + j] + carry;
+            product.words[i + j] = static_cast<uint64_t>(value);
+            carry = static_cast<uint64_t>(value >> 64u);
+        }
+    }
+    result = product;
+}
+
+void div_mod(const WideValue &left, const WideValue &right, WideValue *quotient,
+             WideValue *remainder) {
+    WideValue q, r;
+    if (!right.zero()) {
+        // bit-serial long division, starting from the highest set bit of the dividend
+        auto top = static_cast<int>(WideValue::num_words) - 1;
+        while (top >= 0 && !left.words[top]) top--;
+        for (auto bit = (top + 1) * 64 - 1; bit >= 0; bit--) {
+            // r = r << 1 | next bit
+            for (auto i = WideValue::num_words - 1; i > 0; i--) {
+                r.words[i] = r.words[i] << 1u | r.words[i - 1] >> 63u;
+            }
+            r.words[0] = r.words[0] << 1u | ((left.words[bit / 64] >> (bit % 64)) & 1u);
+            if (compare(r, right) >= 0) {
+                sub(r, right, r);
+                q.words[bit / 64] |= 1ull << (bit % 64);
+            }
+        }
+    }
+    if (quotient) *quotient = q;
+    if (remainder) *remainder = r;
+}
+
+void negate(const WideValue &value, WideValue &result) {
+    uint64_t carry = 1;
+    for (auto i = 0u; i < WideValue::num_words; i++) {
+        auto sum = static_cast<uint128_t>(~value.words[i]) + carry;
+        result.words[i] = static_cast<uint64_t>(sum);
+        carry = static_cast<uint64_t>(sum >> 64u);
+    }
+}
+
+int compare(const WideValue &left, const WideValue &right) {
+    for (auto i = WideValue::num_words; i > 0; i--) {
+        auto l = left.words[i - 1], r = right.words[i - 1];
+        if (l != r) return l < r ? -1 : 1;
+    }
+    return 0;
+}
+
+}  // namespace wide
+
+}  // namespace hgdb
@@ -0,0 +1,51 @@
+#ifndef HGDB_WIDE_HH
+#define HGDB_WIDE_HH
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace hgdb {
+
+// fixed-capacity integer for signals wider than 64 bits, e.g. 128-bit or 512-bit buses.
+// words are stored least significant first in two's complement, so narrow values convert
+// without any loss. storage is inline so that reading and evaluating wide signals doesn't
+// allocate
+struct WideValue {
+    static constexpr uint32_t num_words = 8;
+    static constexpr uint32_t max_width = num_words * 64;
+    std::array<uint64_t, num_words> words{};
+
+    WideValue() = default;
+    // sign extended
+    explicit WideValue(int64_t value);
+    // zero extended from the lowest width bits. 0 means all 64 bits
+    static WideValue zero_extend(int64_t value, uint32_t width);
+
+    [[nodiscard]] bool zero() const;
+    // value as a 64-bit integer if it fits
+    [[nodiscard]] std::optional<int64_t> narrow() const;
+    // same format as RTLSimulatorClient::get_str_value
+    [[nodiscard]] std::string hex_str() const;
+
+    bool operator==(const WideValue &) const = default;
+};
+
+namespace wide {
+// word-parallel kernels. arithmetic wraps around at max_width bits. division and comparison
+// treat values as unsigned, which is how multi-word buses are declared in RTL
+void add(const WideValue &left, const WideValue &right, WideValue &result);
+void sub(const WideValue &left, const WideValue &right, WideValue &result);
+void mul(const WideValue &left, const WideValue &right, WideValue &result);
+// division by zero returns 0, same as the 64-bit evaluation
+void div_mod(const WideValue &left, const WideValue &right, WideValue *quotient,
+             WideValue *remainder);
+void negate(const WideValue &value, WideValue &result);
+// -1, 0, or 1
+int compare(const WideValue &left, const WideValue &right);
+}  // namespace wide
+
+}  // namespace hgdb
+
+#endif  // HGDB_WIDE_HH
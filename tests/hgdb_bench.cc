@@ -0,0 +1,239 @@
+// micro benchmark for the scheduler and the evaluation loop. the design is synthesized on top
+// of MockVPIProvider so that it can be run without any simulator
+//
+// usage: hgdb_bench [--breakpoints=N] [--instances=M] [--namespaces=K] [--terms=C]
+//                   [--cycles=CYCLES] [--mode=all|normal|step-over|reverse]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "db.hh"
+#include "debug.hh"
+#include "fmt/format.h"
+#include "test_util.hh"
+
+// count heap allocations made inside the measured region
+static std::atomic<uint64_t> num_allocations = 0;
+
+void *operator new(std::size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto *p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace hgdb {
+
+class DebuggerTestFriend {
+public:
+    explicit DebuggerTestFriend(Debugger *debugger) : debugger_(debugger) {}
+
+    void start_breakpoint_evaluation() { debugger_->start_breakpoint_evaluation(std::nullopt); }
+    auto eval_breakpoints(const std::vector<DebugBreakPoint *> &bps) {
+        return debugger_->eval_breakpoints(bps);
+    }
+
+private:
+    Debugger *debugger_;
+};
+
+}  // namespace hgdb
+
+struct BenchConfig {
+    uint64_t breakpoints = 1000;
+    uint64_t instances = 100;
+    uint64_t namespaces = 1;
+    // number of signals read by each breakpoint condition
+    uint64_t terms = 1;
+    uint64_t cycles = 1000;
+    std::string mode = "all";
+};
+
+struct BenchResult {
+    uint64_t cycles = 0;
+    uint64_t evaluations = 0;
+    uint64_t allocations = 0;
+    std::chrono::nanoseconds time{0};
+};
+
+BenchConfig parse_args(int argc, char *argv[]) {
+    BenchConfig config;
+    auto parse = [](const std::string &arg, const std::string &name, uint64_t &value) {
+        auto prefix = "--" + name + "=";
+        if (!arg.starts_with(prefix)) return false;
+        value = std::stoull(arg.substr(prefix.size()));
+        return true;
+    };
+    for (auto i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (parse(arg, "breakpoints", config.breakpoints) ||
+            parse(arg, "instances", config.instances) ||
+            parse(arg, "namespaces", config.namespaces) || parse(arg, "terms", config.terms) ||
+            parse(arg, "cycles", config.cycles)) {
+            continue;
+        }
+        if (arg.starts_with("--mode=")) {
+            config.mode = arg.substr(7);
+        } else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    if (config.instances == 0 || config.namespaces == 0 || config.terms == 0) {
+        std::cerr << "instances, namespaces, and terms have to be positive" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return config;
+}
+
+/*
+ * module child;
+ * logic a0, a1, ...;  // one signal per condition term, all set to 0
+ * endmodule
+ *
+ * module dut;
+ * child inst0(); child inst1(); ...
+ * endmodule
+ *
+ * module TOP;
+ * dut dut0(); dut dut1(); ...  // one namespace per dut instance
+ * endmodule
+ *
+ * breakpoint i is placed in instance i % M at line i / M, with condition
+ * a0 + a1 + ... == 42, which is never true
+ */
+std::unique_ptr<hgdb::Debugger> setup_debugger(const BenchConfig &config) {
+    using namespace hgdb;
+    auto mock = std::make_unique<MockVPIProvider>();
+    auto db = std::make_unique<SQLiteDebugDatabase>(init_debug_db(":memory:"));
+    db->sync_schema();
+
+    std::vector<std::string> terms;
+    for (auto i = 0u; i < config.terms; i++) {
+        terms.emplace_back(fmt::format("a{0}", i));
+    }
+    auto condition = fmt::format("({0}) == 42", fmt::join(terms, " + "));
+
+    auto *top = mock->add_module("TOP", "TOP");
+    mock->set_top(top);
+    for (auto ns = 0u; ns < config.namespaces; ns++) {
+        auto dut_name = fmt::format("TOP.dut{0}", ns);
+        mock->add_module("dut", dut_name);
+        for (auto i = 0u; i < config.instances; i++) {
+            auto *inst = mock->add_module("child", fmt::format("{0}.inst{1}", dut_name, i));
+            for (auto const &term : terms) {
+                auto *signal = mock->add_signal(inst, term);
+                mock->set_signal_value(signal, 0);
+            }
+        }
+    }
+    // no rewind so that reverse evaluation stops at the first breakpoint
+    mock->set_rewind_enabled(false);
+
+    store_instance(*db, 0, "dut");
+    for (auto i = 0u; i < config.instances; i++) {
+        store_instance(*db, i + 1, fmt::format("dut.inst{0}", i));
+    }
+    for (auto i = 0u; i < config.breakpoints; i++) {
+        store_breakpoint(*db, i, i % config.instances + 1, "bench.sv", i / config.instances, 0,
+                         condition);
+    }
+
+    auto debugger = std::make_unique<Debugger>(std::move(mock));
+    debugger->initialize_db(std::make_unique<DBSymbolTableProvider>(std::move(db)));
+    auto *scheduler = debugger->scheduler();
+    for (auto const &bp : debugger->db()->get_breakpoints("bench.sv")) {
+        scheduler->add_breakpoint(bp, bp);
+    }
+    return debugger;
+}
+
+BenchResult run_normal(hgdb::Debugger &debugger, MockVPIProvider &mock, uint64_t cycles) {
+    debugger.scheduler()->set_evaluation_mode(hgdb::Scheduler::EvaluationMode::BreakPointOnly);
+    BenchResult result;
+    auto const start_allocations = num_allocations.load();
+    auto const start = std::chrono::steady_clock::now();
+    for (auto cycle = 0u; cycle < cycles; cycle++) {
+        mock.set_time(cycle * 2);
+        debugger.eval();
+    }
+    result.time = std::chrono::steady_clock::now() - start;
+    result.allocations = num_allocations.load() - start_allocations;
+    result.cycles = cycles;
+    result.evaluations = cycles * debugger.scheduler()->get_current_breakpoints().size();
+    return result;
+}
+
+BenchResult run_step(hgdb::Debugger &debugger, MockVPIProvider &mock, uint64_t cycles,
+                     hgdb::Scheduler::EvaluationMode mode, uint64_t max_steps) {
+    hgdb::DebuggerTestFriend debugger_friend(&debugger);
+    auto *scheduler = debugger.scheduler();
+    scheduler->set_evaluation_mode(mode);
+    BenchResult result;
+    auto const start_allocations = num_allocations.load();
+    auto const start = std::chrono::steady_clock::now();
+    for (auto cycle = 0u; cycle < cycles; cycle++) {
+        mock.set_time(cycle * 2);
+        debugger_friend.start_breakpoint_evaluation();
+        std::optional<uint32_t> last_id;
+        for (auto step = 0u; step < max_steps; step++) {
+            auto bps = scheduler->next_breakpoints();
+            // reverse evaluation gets stuck at the first breakpoint without rewind
+            if (bps.empty() || bps.front()->id == last_id) break;
+            last_id = bps.front()->id;
+            debugger_friend.eval_breakpoints(bps);
+            result.evaluations += bps.size();
+        }
+    }
+    result.time = std::chrono::steady_clock::now() - start;
+    result.allocations = num_allocations.load() - start_allocations;
+    result.cycles = cycles;
+    return result;
+}
+
+void report(const std::string &mode, const BenchResult &result) {
+    using namespace std::chrono;
+    auto cycles = std::max<uint64_t>(result.cycles, 1);
+    auto ns = static_cast<double>(duration_cast<nanoseconds>(result.time).count());
+    auto seconds = ns / 1e9;
+    std::cout << fmt::format("{0:<10} {1:>12.1f} {2:>16.0f} {3:>14.1f}", mode, ns / 1e3 / cycles,
+                             seconds > 0 ? static_cast<double>(result.evaluations) / seconds : 0,
+                             static_cast<double>(result.allocations) / cycles)
+              << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    auto config = parse_args(argc, argv);
+    auto debugger = setup_debugger(config);
+    auto &mock = *reinterpret_cast<MockVPIProvider *>(debugger->rtl_clients()[0]->vpi().get());
+
+    std::cout << fmt::format("breakpoints: {0} instances: {1} namespaces: {2} terms: {3}",
+                             config.breakpoints, config.instances, config.namespaces,
+                             config.terms)
+              << std::endl;
+    std::cout << fmt::format("{0:<10} {1:>12} {2:>16} {3:>14}", "mode", "us/cycle",
+                             "breakpoints/s", "allocs/cycle")
+              << std::endl;
+
+    using EvaluationMode = hgdb::Scheduler::EvaluationMode;
+    auto const all = config.mode == "all";
+    if (all || config.mode == "normal") {
+        report("normal", run_normal(*debugger, mock, config.cycles));
+    }
+    if (all || config.mode == "step-over") {
+        report("step-over", run_step(*debugger, mock, config.cycles, EvaluationMode::StepOver,
+                                     config.breakpoints));
+    }
+    if (all || config.mode == "reverse") {
+        report("reverse", run_step(*debugger, mock, config.cycles,
+                                   EvaluationMode::ReverseBreakpointOnly, config.breakpoints));
+    }
+
+    return EXIT_SUCCESS;
+}
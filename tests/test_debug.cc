@@ -15,6 +15,19 @@ public:
         return debugger_->eval_breakpoints(bps);
     }
 
+    bool should_trigger(DebugBreakPoint *bp) { return debugger_->should_trigger(bp); }
+
+    void add_breakpoint(const BreakPoint &bp) { debugger_->add_breakpoint(bp, bp); }
+    auto get_breakpoint_hit_response(const std::vector<const DebugBreakPoint *> &bps) {
+        return debugger_->get_breakpoint_hit_response(bps);
+    }
+    void start_breakpoint_evaluation() { debugger_->start_breakpoint_evaluation(std::nullopt); }
+    void add_cb_clocks() { debugger_->add_cb_clocks(); }
+    void enter_idle() { debugger_->enter_idle(); }
+    void request_exit_idle() { debugger_->request_exit_idle(); }
+    void set_pause_at_posedge(bool value) { debugger_->pause_at_posedge = value; }
+    Monitor *monitor() { return debugger_->namespaces_[0]->monitor.get(); }
+
 private:
     Debugger *debugger_;
 };
@@ -88,6 +101,8 @@ public:
         // instances
         auto *top = mock->add_module("TOP", "TOP");
         mock->set_top(top);
+        mock->add_signal(top, "TOP.clk");
+        store_annotation(*db, "clock", "$root.TOP.clk");
         for (auto i = 0; i < num_instances; i++) {
             auto instance_name = fmt::format("inst{0}", i);
             store_instance(*db, i, instance_name);
@@ -97,6 +112,14 @@ public:
             auto *v = mock->add_signal(p, "a");
             mock->set_signal_value(v, 1);
         }
+        // variables reported when inst0 hits
+        store_variable(*db, 0, "a");
+        store_variable(*db, 1, "42", false);
+        store_generator_variable(*db, "gen_a", 0, 0);
+        store_generator_variable(*db, "gen_const", 0, 1);
+        store_context_variable(*db, "ctx_a", 0, 0);
+        store_context_variable(*db, "ctx_const", 0, 1);
+        store_context_variable(*db, "ctx_delayed", 0, 0, true);
 
         debugger_ = std::make_unique<Debugger>(std::move(mock));
         friend_ = std::make_unique<DebuggerTestFriend>(debugger_.get());
@@ -142,4 +165,174 @@ TEST_F(InMemoryPerfDebuggerTester, debugger_misc_perf) {
         debugger_->eval();
     }
 }
+
+TEST_F(InMemoryPerfDebuggerTester, value_snapshot_scope) {
+    auto breakpoints = db_->get_breakpoints(filename, line);
+    // reads a without ever hitting
+    for (auto &bp : breakpoints) {
+        bp.condition = "a == 2";
+    }
+    for (auto const &bp : breakpoints) {
+        debugger_->scheduler()->add_breakpoint(bp, bp);
+    }
+    debugger_->set_option("use_signal_cache", true);
+    auto *rtl = debugger_->rtl_clients()[0];
+    auto *mock = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    auto *handle = mock->vpi_handle_by_name(const_cast<char *>("a"), nullptr);
+    debugger_->eval();
+    // the simulator moves on after the evaluation cycle. reads outside the cycle, e.g. from
+    // client requests, should not be served from the stale snapshot
+    mock->set_signal_value(handle, 2);
+    EXPECT_EQ(rtl->get_value(handle), 2);
+}
+
+TEST_F(InMemoryPerfDebuggerTester, trigger_edges) {  // NOLINT
+    auto *rtl = debugger_->rtl_clients()[0];
+    auto *mock = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    auto *module = mock->vpi_handle_by_name(const_cast<char *>("TOP.inst0_inst"), nullptr);
+    std::array<vpiHandle, 3> handles = {};
+    DebugBreakPoint bp;
+    for (auto i = 0u; i < handles.size(); i++) {
+        auto name = fmt::format("t{0}", i);
+        handles[i] = mock->add_signal(module, name);
+        mock->set_signal_value(handles[i], 0);
+        bp.trigger_names.emplace_back(name);
+        bp.trigger_handles.emplace_back(handles[i]);
+    }
+    bp.trigger_values.resize(handles.size());
+
+    // the first evaluation always triggers
+    EXPECT_TRUE(friend_->should_trigger(&bp));
+    EXPECT_FALSE(friend_->should_trigger(&bp));
+    // a change in any of the symbols triggers once
+    for (auto *handle : handles) {
+        mock->set_signal_value(handle, 1);
+        EXPECT_TRUE(friend_->should_trigger(&bp));
+        EXPECT_FALSE(friend_->should_trigger(&bp));
+    }
+    // several symbols changing at the same time
+    mock->set_signal_value(handles[0], 0);
+    mock->set_signal_value(handles[2], 0);
+    EXPECT_TRUE(friend_->should_trigger(&bp));
+    EXPECT_FALSE(friend_->should_trigger(&bp));
+    // values stay aligned with their handles
+    EXPECT_EQ(bp.trigger_values, (std::vector<int64_t>{0, 1, 0}));
+}
+
+TEST_F(InMemoryPerfDebuggerTester, idle_mode) {  // NOLINT
+    auto *rtl = debugger_->rtl_clients()[0];
+    auto *mock = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    auto clock_armed = [rtl]() { return rtl->callback_names().contains("Monitor TOP.clk"); };
+    auto num_wake_ups = [mock]() { return mock->get_cb_funcs(cbNextSimTime).size(); };
+    debugger_->set_option("idle_mode", true);
+    friend_->add_cb_clocks();
+    EXPECT_TRUE(clock_armed());
+
+    // nothing to evaluate
+    friend_->enter_idle();
+    EXPECT_FALSE(clock_armed());
+    EXPECT_EQ(num_wake_ups(), 1);
+    // no request in between
+    mock->trigger_next_sim_time();
+    EXPECT_FALSE(clock_armed());
+    EXPECT_EQ(num_wake_ups(), 1);
+
+    // breakpoint added by the client. callbacks are only restored from the simulator thread
+    auto bp = *db_->get_breakpoint(0);
+    debugger_->scheduler()->add_breakpoint(bp, bp);
+    friend_->request_exit_idle();
+    EXPECT_FALSE(clock_armed());
+    mock->trigger_next_sim_time();
+    EXPECT_TRUE(clock_armed());
+    EXPECT_EQ(num_wake_ups(), 0);
+    debugger_->scheduler()->remove_breakpoint(bp, DebugBreakPoint::Type::normal);
+    friend_->enter_idle();
+    EXPECT_FALSE(clock_armed());
+
+    // monitor added by the client
+    auto watch_id = friend_->monitor()->add_monitor_variable(
+        "TOP.clk", MonitorRequest::MonitorType::clock_edge);
+    friend_->request_exit_idle();
+    mock->trigger_next_sim_time();
+    EXPECT_TRUE(clock_armed());
+    friend_->monitor()->remove_monitor_variable(watch_id);
+    friend_->enter_idle();
+    EXPECT_FALSE(clock_armed());
+
+    // pausing at the next clock edge needs the callbacks, and keeps them
+    friend_->set_pause_at_posedge(true);
+    friend_->request_exit_idle();
+    mock->trigger_next_sim_time();
+    EXPECT_TRUE(clock_armed());
+    friend_->enter_idle();
+    EXPECT_TRUE(clock_armed());
+    EXPECT_EQ(num_wake_ups(), 0);
+}
+
+TEST_F(InMemoryPerfDebuggerTester, change_driven_evaluation) {  // NOLINT
+    auto *rtl = debugger_->rtl_clients()[0];
+    auto *mock = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    debugger_->set_option("change_driven_evaluation", true);
+    // a == 1
+    auto bp = *db_->get_breakpoint(0);
+    auto *debug_bp = debugger_->scheduler()->add_breakpoint(bp, bp);
+    ASSERT_NE(debug_bp, nullptr);
+    friend_->start_breakpoint_evaluation();
+    EXPECT_TRUE(debug_bp->change_driven);
+    ASSERT_EQ(debug_bp->dependencies.size(), 1);
+
+    std::vector<DebugBreakPoint *> bps = {debug_bp};
+    EXPECT_TRUE(friend_->eval_breakpoints(bps)[0]);
+    EXPECT_EQ(debug_bp->cached_result, 1);
+    // the cached result is used as long as nothing changes
+    debug_bp->cached_result = 0;
+    EXPECT_FALSE(friend_->eval_breakpoints(bps)[0]);
+    debug_bp->cached_result = 1;
+    // a change on the signal forces the condition to be evaluated again
+    mock->set_signal_value(debug_bp->dependencies[0], 2);
+    EXPECT_FALSE(debug_bp->cached_result);
+    EXPECT_FALSE(friend_->eval_breakpoints(bps)[0]);
+    EXPECT_EQ(debug_bp->cached_result, 0);
+}
+
+TEST_F(InMemoryPerfDebuggerTester, breakpoint_hit_response) {  // NOLINT
+    auto *rtl = debugger_->rtl_clients()[0];
+    auto *mock = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    auto bp = *db_->get_breakpoint(0);
+    friend_->add_breakpoint(bp);
+    auto *debug_bp = debugger_->scheduler()->get_breakpoint(0);
+    ASSERT_NE(debug_bp, nullptr);
+    auto *handle = debug_bp->expr->get_resolved_symbol_handles()[0].handle;
+    std::vector<const DebugBreakPoint *> bps = {debug_bp};
+
+    // built the same way as before responses were planned
+    auto expected = [&](const std::string &value, const std::string &delayed_value) {
+        BreakPointResponse resp(0, filename, line);
+        BreakPointResponse::Scope scope(0, rtl->get_full_name("inst0"), 0);
+        scope.bp_type = "normal";
+        scope.add_generator_value("gen_a", value);
+        scope.add_generator_value("gen_const", "42");
+        scope.add_local_value("ctx_a", value);
+        scope.add_local_value("ctx_const", "42");
+        scope.add_local_value("ctx_delayed", delayed_value);
+        resp.add_scope(scope);
+        return resp.str(false);
+    };
+
+    // the first hit builds the plan
+    EXPECT_EQ(friend_->get_breakpoint_hit_response(bps).str(false), expected("1", "1"));
+    // the second one only reads values. the delayed value is still from the last cycle
+    mock->set_signal_value(handle, 10);
+    EXPECT_EQ(friend_->get_breakpoint_hit_response(bps).str(false), expected("10", "1"));
+
+    debugger_->set_option("use_hex_str", true);
+    EXPECT_EQ(friend_->get_breakpoint_hit_response(bps).str(false),
+              expected("0x0000000A", "0x00000001"));
+    mock->set_signal_value(handle, 1);
+    EXPECT_EQ(friend_->get_breakpoint_hit_response(bps).str(false),
+              expected("0x00000001", "0x00000001"));
+    debugger_->set_option("use_hex_str", false);
+    EXPECT_EQ(friend_->get_breakpoint_hit_response(bps).str(false), expected("1", "1"));
+}
+
 }  // namespace hgdb
@@ -163,6 +163,27 @@ def test_breakpoint_hit_continue(start_server, find_free_port):
     kill_server(s)
 
 
+def test_breakpoint_hit_count(start_server, find_free_port):
+    s, uri = setup_server(start_server, find_free_port)
+
+    async def test_logic():
+        client = hgdb.HGDBClient(uri, None)
+        await client.connect()
+        # line 1 is hit by both instances at every cycle. only the third hit is reported
+        await client.set_breakpoint("/tmp/test.py", 1, hit_count="== 3")
+        await client.continue_()
+        bp_info = await client.recv_bp()
+        assert bp_info["payload"]["line_num"] == 1
+        assert bp_info["payload"]["time"] == 2
+        assert len(bp_info["payload"]["instances"]) == 2
+        await client.continue_()
+        # non-qualifying hits neither pause the simulation nor reach the client
+        assert await client.recv_bp(timeout=0.5) is None
+
+    asyncio.get_event_loop_policy().get_event_loop().run_until_complete(test_logic())
+    kill_server(s)
+
+
 def test_breakpoint_step_over(start_server, find_free_port):
     s, uri = setup_server(start_server, find_free_port)
 
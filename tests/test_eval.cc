@@ -1,3 +1,7 @@
+#include <array>
+#include <limits>
+#include <map>
+
 #include "../src/eval.hh"
 #include "gtest/gtest.h"
 
@@ -135,4 +139,284 @@ TEST(expr, expr_eval) {  // NOLINT
     debug_expr9.set_value("a", 4);
     result = debug_expr9.eval();
     EXPECT_EQ(result, 0);
-}
\ No newline at end of file
+}
+
+TEST(expr, expr_slot_eval) {  // NOLINT
+    auto const *expr = "a + b * a - c / d";
+    hgdb::DebugExpression debug_expr(expr);
+    EXPECT_TRUE(debug_expr.correct());
+    EXPECT_EQ(debug_expr.num_slots(), 4);
+    auto slot_a = debug_expr.get_slot("a");
+    auto slot_b = debug_expr.get_slot("b");
+    auto slot_c = debug_expr.get_slot("c");
+    auto slot_d = debug_expr.get_slot("d");
+    EXPECT_TRUE(slot_a && slot_b && slot_c && slot_d);
+    EXPECT_FALSE(debug_expr.get_slot("e"));
+    debug_expr.set_value(*slot_a, 2);
+    debug_expr.set_value(*slot_b, 3);
+    debug_expr.set_value(*slot_c, 8);
+    debug_expr.set_value(*slot_d, 4);
+    EXPECT_EQ(debug_expr.eval(), 2 + 3 * 2 - 8 / 4);
+    // re-evaluate with a new value
+    debug_expr.set_value(*slot_a, 1);
+    EXPECT_EQ(debug_expr.eval(), 1 + 3 * 1 - 8 / 4);
+    // division by zero does not bring down the simulator
+    debug_expr.set_value(*slot_d, 0);
+    EXPECT_EQ(debug_expr.eval(), 1 + 3 * 1);
+
+    // static values are baked into the slot
+    hgdb::DebugExpression debug_expr2("a == b");
+    debug_expr2.set_static_values({{"b", 42}});
+    EXPECT_EQ(debug_expr2.get_required_symbols().size(), 1);
+    debug_expr2.set_value("a", 42);
+    EXPECT_EQ(debug_expr2.eval(), 1);
+}
+
+TEST(expr, expr_symbol_binding) {  // NOLINT
+    using Kind = hgdb::DebugExpression::SymbolBinding::Kind;
+    hgdb::DebugExpression debug_expr("a + $time");
+    int dummy;
+    auto *handle = reinterpret_cast<hgdb::DebugExpression::vpiHandle>(&dummy);
+    debug_expr.set_resolved_symbol_handle("a", handle);
+    debug_expr.set_resolved_symbol_handle("$time", nullptr, Kind::time);
+    // duplicated resolution is ignored
+    debug_expr.set_resolved_symbol_handle("a", handle);
+    auto const &bindings = debug_expr.get_resolved_symbol_handles();
+    EXPECT_EQ(bindings.size(), 2);
+    for (auto const &binding : bindings) {
+        if (binding.kind == Kind::signal) {
+            EXPECT_EQ(binding.handle, handle);
+            EXPECT_EQ(binding.slot, *debug_expr.get_slot("a"));
+            debug_expr.set_value(binding.slot, 40);
+        } else {
+            EXPECT_EQ(binding.slot, *debug_expr.get_slot("$time"));
+            debug_expr.set_value(binding.slot, 2);
+        }
+    }
+    EXPECT_EQ(debug_expr.eval(), 42);
+}
+
+TEST(expr, expr_lane_eval) {  // NOLINT
+    auto const *expr = "(a + 1) * (b - 2) == c || !(a % d)";
+    constexpr auto num_lanes = 37;
+    std::vector<std::unique_ptr<hgdb::DebugExpression>> exprs;
+    std::vector<const hgdb::DebugExpression *> lanes;
+    for (auto i = 0; i < num_lanes; i++) {
+        auto &e = exprs.emplace_back(std::make_unique<hgdb::DebugExpression>(expr));
+        e->set_values({{"a", i}, {"b", i * 3}, {"c", i * i}, {"d", i % 5}});
+        lanes.emplace_back(e.get());
+    }
+    EXPECT_TRUE(exprs[0]->same_program(*exprs[1]));
+    hgdb::DebugExpression other("a + 1");
+    EXPECT_FALSE(exprs[0]->same_program(other));
+
+    std::vector<hgdb::ExpressionType> results(num_lanes);
+    exprs[0]->eval(lanes, results);
+    for (auto i = 0; i < num_lanes; i++) {
+        EXPECT_EQ(results[i], exprs[i]->eval());
+    }
+}
+
+TEST(expr, expr_constant_fold) {  // NOLINT
+    hgdb::DebugExpression literal("1 + 2 == 3");
+    EXPECT_EQ(*literal.constant_value(), 1);
+
+    hgdb::DebugExpression guard("WIDTH > 4 && a");
+    EXPECT_FALSE(guard.constant_value());
+    guard.set_static_values({{"WIDTH", 2}});
+    EXPECT_EQ(*guard.constant_value(), 0);
+    EXPECT_EQ(guard.eval(), 0);
+
+    hgdb::DebugExpression partial("(WIDTH + 1) * a");
+    partial.set_static_values({{"WIDTH", 2}});
+    EXPECT_FALSE(partial.constant_value());
+    partial.set_value("a", 5);
+    EXPECT_EQ(partial.eval(), 15);
+}
+
+TEST(expr, expr_graph) {  // NOLINT
+    using vpiHandle = hgdb::DebugExpression::vpiHandle;
+    std::array<int, 4> dummy{};
+    std::map<std::string, vpiHandle> handles;
+    std::map<vpiHandle, int64_t> values;
+    for (auto i = 0u; i < dummy.size(); i++) {
+        auto *handle = reinterpret_cast<vpiHandle>(&dummy[i]);
+        handles.emplace(std::string(1, static_cast<char>('a' + i)), handle);
+        values.emplace(handle, 0);
+    }
+    auto bind = [&handles](hgdb::DebugExpression &expr) {
+        // bind in a fixed order so that node ids are deterministic
+        for (auto const &[name, handle] : handles) {
+            if (expr.find(name) != expr.end()) expr.set_resolved_symbol_handle(name, handle);
+        }
+    };
+
+    hgdb::ExpressionGraph graph;
+    hgdb::DebugExpression expr1("a && b && c == 3");
+    hgdb::DebugExpression expr2("a && b && d");
+    // commutative operands are normalized
+    hgdb::DebugExpression expr3("3 == c");
+    hgdb::DebugExpression unbound("a + e");
+    bind(expr1);
+    bind(expr2);
+    bind(expr3);
+    auto node1 = graph.intern(expr1, 0);
+    auto size = graph.size();
+    auto node2 = graph.intern(expr2, 0);
+    // only d and the top-level and are new
+    EXPECT_EQ(graph.size(), size + 2);
+    auto node3 = graph.intern(expr3, 0);
+    EXPECT_EQ(graph.size(), size + 2);
+    EXPECT_FALSE(graph.intern(unbound, 0));
+    ASSERT_TRUE(node1 && node2 && node3);
+    EXPECT_EQ(*graph.intern(expr1, 0), *node1);
+
+    uint64_t num_reads = 0;
+    auto read = [&](vpiHandle handle) -> std::optional<int64_t> {
+        num_reads++;
+        return values.at(handle);
+    };
+    values[handles.at("a")] = 1;
+    values[handles.at("b")] = 1;
+    values[handles.at("c")] = 3;
+    graph.next_epoch(0);
+    EXPECT_EQ(*graph.eval(*node1, read), 1);
+    EXPECT_EQ(*graph.eval(*node2, read), 0);
+    EXPECT_EQ(*graph.eval(*node3, read), 1);
+    // each signal is read once per epoch
+    EXPECT_EQ(num_reads, 4);
+
+    // short-circuit skips the other operands
+    values[handles.at("a")] = 0;
+    graph.next_epoch(1);
+    num_reads = 0;
+    EXPECT_EQ(*graph.eval(*node1, read), 0);
+    EXPECT_EQ(*graph.eval(*node2, read), 0);
+    EXPECT_EQ(num_reads, 1);
+
+    auto failed_read = [](vpiHandle) -> std::optional<int64_t> { return std::nullopt; };
+    graph.next_epoch(2);
+    EXPECT_FALSE(graph.eval(*node1, failed_read));
+}
+
+TEST(expr, expr_wide_eval) {  // NOLINT
+    using Kind = hgdb::DebugExpression::SymbolBinding::Kind;
+    hgdb::WideValue a;
+    a.words[0] = ~0ull;
+    hgdb::WideValue one(1), sum, product, quotient, remainder;
+    hgdb::wide::add(a, one, sum);
+    EXPECT_EQ(sum.words[0], 0);
+    EXPECT_EQ(sum.words[1], 1);
+    hgdb::wide::sub(sum, one, sum);
+    EXPECT_EQ(sum, a);
+    hgdb::wide::mul(a, a, product);
+    // (2^64 - 1)^2 = 2^128 - 2^65 + 1
+    EXPECT_EQ(product.words[0], 1);
+    EXPECT_EQ(product.words[1], ~0ull - 1);
+    hgdb::wide::div_mod(product, a, &quotient, &remainder);
+    EXPECT_EQ(quotient, a);
+    EXPECT_TRUE(remainder.zero());
+    EXPECT_GT(hgdb::wide::compare(product, a), 0);
+    EXPECT_EQ(hgdb::WideValue(-1).narrow(), -1);
+    EXPECT_FALSE(product.narrow());
+
+    int dummy[2];
+    auto *a_handle = reinterpret_cast<hgdb::DebugExpression::vpiHandle>(&dummy[0]);
+    auto *b_handle = reinterpret_cast<hgdb::DebugExpression::vpiHandle>(&dummy[1]);
+    hgdb::DebugExpression expr("a * a / a == a && b + 1 > a");
+    expr.set_resolved_symbol_handle("a", a_handle, Kind::wide_signal);
+    expr.set_resolved_symbol_handle("b", b_handle, Kind::wide_signal);
+    EXPECT_TRUE(expr.wide());
+    expr.set_value(*expr.get_slot("a"), a);
+    expr.set_value(*expr.get_slot("b"), a);
+    EXPECT_EQ(expr.eval(), 1);
+    expr.set_value(*expr.get_slot("b"), hgdb::WideValue(3));
+    EXPECT_EQ(expr.eval(), 0);
+
+    hgdb::DebugExpression mixed("a + c");
+    mixed.set_resolved_symbol_handle("a", a_handle, Kind::wide_signal);
+    mixed.set_value(*mixed.get_slot("a"), a);
+    mixed.set_value("c", 2);
+    auto result = mixed.eval_wide();
+    EXPECT_EQ(result.words[0], 1);
+    EXPECT_EQ(result.words[1], 1);
+    // doesn't fit in 64 bits
+    EXPECT_EQ(mixed.eval(), std::numeric_limits<int64_t>::max());
+
+    // narrow signals are zero extended from their width, only literals are sign extended
+    int dummy2[2];
+    auto *n_handle = reinterpret_cast<hgdb::DebugExpression::vpiHandle>(&dummy2[0]);
+    auto *m_handle = reinterpret_cast<hgdb::DebugExpression::vpiHandle>(&dummy2[1]);
+    hgdb::DebugExpression compare("w == n && w > m && w - n < m");
+    compare.set_resolved_symbol_handle("w", a_handle, Kind::wide_signal);
+    compare.set_resolved_symbol_handle("n", n_handle, Kind::signal, 64);
+    compare.set_resolved_symbol_handle("m", m_handle, Kind::signal, 32);
+    hgdb::WideValue msb;
+    msb.words[0] = 1ull << 63;
+    compare.set_value(*compare.get_slot("w"), msb);
+    // 64-bit signal with the msb set, read as a negative integer
+    compare.set_value(*compare.get_slot("n"), std::numeric_limits<int64_t>::min());
+    // 32-bit signal of all ones, read as -1
+    compare.set_value(*compare.get_slot("m"), -1);
+    EXPECT_EQ(compare.eval(), 1);
+    hgdb::DebugExpression literal("w > -1");
+    literal.set_resolved_symbol_handle("w", a_handle, Kind::wide_signal);
+    literal.set_value(*literal.get_slot("w"), msb);
+    EXPECT_EQ(literal.eval(), 0);
+}
+
+TEST(expr, expr_parse_cache) {  // NOLINT
+    auto parsed = hgdb::ParsedExpression::get("a + b * 2 > c");
+    EXPECT_EQ(hgdb::ParsedExpression::get("a + b * 2 > c"), parsed);
+    EXPECT_NE(hgdb::ParsedExpression::get("a + b * 2 < c"), parsed);
+
+    // expressions built from the same string share the parse but not the values
+    hgdb::DebugExpression expr1("a + b * 2 > c");
+    hgdb::DebugExpression expr2("a + b * 2 > c");
+    expr1.set_values({{"a", 1}, {"b", 2}, {"c", 3}});
+    expr2.set_static_values({{"b", 0}});
+    expr2.set_values({{"a", 1}, {"c", 3}});
+    EXPECT_EQ(expr1.eval(), 1);
+    EXPECT_EQ(expr2.eval(), 0);
+    EXPECT_EQ(expr2.get_required_symbols().size(), 2);
+    EXPECT_EQ(expr1.get_required_symbols().size(), 3);
+
+    // errors are cached as well
+    hgdb::DebugExpression bad1("a +");
+    hgdb::DebugExpression bad2("a +");
+    EXPECT_FALSE(bad1.correct());
+    EXPECT_FALSE(bad2.correct());
+}
+
+TEST(expr, value_change_search) {  // NOLINT
+    hgdb::DebugExpression expr("count == 15 && push");
+    auto count = *expr.get_slot("count");
+    auto push = *expr.get_slot("push");
+    std::vector<hgdb::SlotValueChanges> changes = {
+        {count, {{0, 0}, {10, 15}, {30, 3}, {50, 15}}},
+        {push, {{0, 0}, {5, 1}, {20, 0}, {40, 1}, {60, 0}}}};
+
+    hgdb::ValueChangeSearch search(expr, changes, 0, 100, true, std::nullopt);
+    // 0, 5, 10, 20, 30, 40, 50, 60
+    EXPECT_EQ(search.size(), 8);
+    std::vector<uint64_t> times;
+    search.search(0, search.size(), times);
+    EXPECT_EQ(times, std::vector<uint64_t>({10, 50}));
+
+    // chunks can start anywhere
+    std::vector<uint64_t> chunked;
+    for (auto i = 0u; i < search.size(); i += 3) {
+        search.search(i, i + 3, chunked);
+    }
+    EXPECT_EQ(chunked, times);
+
+    // the start of a continued search is not a change point
+    hgdb::ValueChangeSearch continued(expr, changes, 10, 55, false, std::nullopt);
+    times.clear();
+    continued.search(0, continued.size(), times);
+    EXPECT_EQ(times, std::vector<uint64_t>({50}));
+    hgdb::ValueChangeSearch from_start(expr, changes, 10, 55, true, std::nullopt);
+    times.clear();
+    from_start.search(0, from_start.size(), times);
+    EXPECT_EQ(times, std::vector<uint64_t>({10, 50}));
+}
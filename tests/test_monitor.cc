@@ -56,4 +56,27 @@ TEST(monitor, remove_track) {  // NOLINT
 
     monitor.remove_monitor_variable(id3);
     EXPECT_TRUE(monitor.empty());
-}
\ No newline at end of file
+}
+
+TEST(monitor, time_window) {  // NOLINT
+    auto mock = std::make_shared<MockVPIProvider>();
+    hgdb::RTLSimulatorClient rtl(mock);
+    auto *a = mock->add_signal(nullptr, "a");
+    mock->set_signal_value(a, 42);
+    hgdb::Monitor monitor(&rtl);
+    auto const id = monitor.add_monitor_variable("a", hgdb::Monitor::WatchType::clock_edge);
+    monitor.set_monitor_variable_window(id, {.start = 10, .end = 20});
+
+    mock->set_time(5);
+    EXPECT_TRUE(monitor.get_watched_values(hgdb::Monitor::WatchType::clock_edge).empty());
+    EXPECT_FALSE(monitor.active());
+    EXPECT_FALSE(monitor.idle());
+
+    mock->set_time(10);
+    EXPECT_EQ(monitor.get_watched_values(hgdb::Monitor::WatchType::clock_edge).size(), 1);
+    EXPECT_TRUE(monitor.active());
+
+    mock->set_time(21);
+    EXPECT_TRUE(monitor.get_watched_values(hgdb::Monitor::WatchType::clock_edge).empty());
+    EXPECT_TRUE(monitor.idle());
+}
@@ -77,6 +77,75 @@ TEST(proto, breakpoint_id_request) {  // NOLINT
     EXPECT_EQ(r.bp_action(), hgdb::BreakPointRequest::action::add);
 }
 
+TEST(proto, breakpoint_request_hit_count) {  // NOLINT
+    const auto *req = R"(
+{
+    "filename": "/tmp/abc",
+    "line_num": 123,
+    "action": "add",
+    "hit_count": ">= 5000"
+}
+)";
+    hgdb::BreakPointRequest r;
+    r.parse_payload(req);
+    EXPECT_EQ(r.status(), hgdb::status_code::success);
+    auto const &hit_count = r.hit_count();
+    EXPECT_EQ(hit_count.kind, hgdb::HitCountCondition::Kind::at_least);
+    EXPECT_EQ(hit_count.count, 5000);
+    EXPECT_FALSE(hit_count.satisfied(4999));
+    EXPECT_TRUE(hit_count.satisfied(5000));
+
+    auto every = hgdb::HitCountCondition::parse("% 3");
+    EXPECT_TRUE(every);
+    EXPECT_FALSE(every->satisfied(2));
+    EXPECT_TRUE(every->satisfied(6));
+    EXPECT_FALSE(hgdb::HitCountCondition::parse("% 0"));
+    EXPECT_FALSE(hgdb::HitCountCondition::parse("> 3"));
+
+    const auto *malformed = R"(
+{
+    "id": 42,
+    "action": "add",
+    "hit_count": "sometimes"
+}
+)";
+    hgdb::BreakPointIDRequest r_id;
+    r_id.parse_payload(malformed);
+    EXPECT_EQ(r_id.status(), hgdb::status_code::error);
+}
+
+TEST(proto, breakpoint_request_time_window) {  // NOLINT
+    const auto *req = R"(
+{
+    "filename": "/tmp/abc",
+    "line_num": 123,
+    "action": "add",
+    "start_time": 100,
+    "end_time": 200
+}
+)";
+    hgdb::BreakPointRequest r;
+    r.parse_payload(req);
+    EXPECT_EQ(r.status(), hgdb::status_code::success);
+    auto const &window = r.time_window();
+    EXPECT_TRUE(window.bounded());
+    EXPECT_FALSE(window.contains(99));
+    EXPECT_TRUE(window.contains(200));
+    EXPECT_TRUE(window.closed(201));
+
+    const auto *reversed = R"(
+{
+    "id": 42,
+    "action": "add",
+    "start_time": 200,
+    "end_time": 100
+}
+)";
+    hgdb::BreakPointIDRequest r_id;
+    r_id.parse_payload(reversed);
+    EXPECT_EQ(r_id.status(), hgdb::status_code::error);
+}
+
 TEST(proto, breakpoint_request_malformed) {  // NOLINT
     const auto *req1 = R"(
 {
@@ -241,6 +310,46 @@ TEST(proto, request_parse_evaluation) {  // NOLINT
     EXPECT_TRUE(eval->breakpoint_id());
 }
 
+TEST(proto, request_parse_find_when) {  // NOLINT
+    const auto *req = R"({
+    "request": true,
+    "type": "find-when",
+    "token": "search",
+    "payload": {
+        "instance_id": 1,
+        "expression": "a == 1",
+        "start_time": 10,
+        "end_time": 100,
+        "limit": 4
+    }
+}
+)";
+    auto r = hgdb::Request::parse_request(req);
+    EXPECT_EQ(r->status(), hgdb::status_code::success);
+    auto const *find_when = dynamic_cast<hgdb::FindWhenRequest *>(r.get());
+    EXPECT_NE(find_when, nullptr);
+    EXPECT_EQ(find_when->expression(), "a == 1");
+    EXPECT_EQ(*find_when->instance_id(), 1);
+    EXPECT_FALSE(find_when->breakpoint_id());
+    EXPECT_EQ(find_when->time_window().start, 10);
+    EXPECT_EQ(find_when->time_window().end, 100);
+    EXPECT_EQ(*find_when->limit(), 4);
+    EXPECT_EQ(find_when->get_token(), "search");
+
+    // expression is required
+    const auto *missing = R"({"request": true, "type": "find-when", "payload": {"limit": 4}})";
+    r = hgdb::Request::parse_request(missing);
+    EXPECT_EQ(r->status(), hgdb::status_code::error);
+
+    const auto *reversed = R"({
+    "request": true,
+    "type": "find-when",
+    "payload": {"expression": "a", "start_time": 100, "end_time": 10}
+})";
+    r = hgdb::Request::parse_request(reversed);
+    EXPECT_EQ(r->status(), hgdb::status_code::error);
+}
+
 TEST(proto, request_parse_option_change) {  // NOLINT
     const auto *req = R"({
     "request": true,
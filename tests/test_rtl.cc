@@ -1,6 +1,7 @@
 #include <fmt/format.h>
 
 #include "../src/rtl.hh"
+#include "../src/thread.hh"
 #include "gtest/gtest.h"
 #include "test_util.hh"
 
@@ -251,6 +252,44 @@ TEST_F(RTLModuleTest, test_valid_signal) {  // NOLINT
     EXPECT_FALSE(client->is_valid_signal("parent_mod.x"));
 }
 
+TEST_F(RTLModuleTest, test_design_hierarchy) {  // NOLINT
+    auto hierarchy = client->design_hierarchy();
+    // top, dut, inst1, and inst2
+    EXPECT_EQ(hierarchy->num_instances(), 4);
+    // a, b, clk, and array in each module except for top
+    EXPECT_EQ(hierarchy->num_signals(), 4 * 3);
+    auto const *dut = hierarchy->find_instance("top.dut");
+    ASSERT_NE(dut, nullptr);
+    EXPECT_EQ(dut->def_name, "parent_mod");
+    EXPECT_EQ(dut->children.size(), 2);
+    auto const *inst1 = dut->get_child("inst1");
+    ASSERT_NE(inst1, nullptr);
+    EXPECT_EQ(inst1->full_name, "top.dut.inst1");
+    EXPECT_EQ(inst1->def_name, "child_mod");
+    EXPECT_EQ(inst1->parent, dut);
+    auto const *clk = hierarchy->find_signal("top.dut.inst1.clk");
+    ASSERT_NE(clk, nullptr);
+    EXPECT_EQ(clk->width, 1);
+    EXPECT_EQ(hierarchy->find_signal("top.dut.a")->width, 32);
+    EXPECT_EQ(hierarchy->find_signal("top.dut.x"), nullptr);
+    EXPECT_EQ(hierarchy->find_instance("top.dut.inst3"), nullptr);
+
+    // none of these goes through the simulator hierarchy again
+    auto handle_count = vpi().get_handle_count();
+    EXPECT_TRUE(client->is_valid_signal("parent_mod.inst2.b"));
+    EXPECT_FALSE(client->is_valid_signal("parent_mod.inst2"));
+    EXPECT_EQ(client->get_module_signals("parent_mod.inst2").size(), 4);
+    auto clocks = client->get_clocks_from_design();
+    ASSERT_FALSE(clocks.empty());
+    EXPECT_EQ(clocks[0], "top.dut.clk");
+    EXPECT_EQ(vpi().get_handle_count(), handle_count);
+
+    // other namespaces share the same hierarchy
+    auto other = std::make_unique<hgdb::RTLSimulatorClient>(client->vpi());
+    other->set_design_hierarchy(hierarchy);
+    EXPECT_EQ(other->design_hierarchy(), hierarchy);
+}
+
 TEST_F(RTLModuleTest, test_hex_str) {  // NOLINT
     auto val = client->get_str_value("parent_mod.inst1.a");
     EXPECT_TRUE(val);
@@ -285,6 +324,68 @@ TEST_F(RTLModuleTest, test_slice) {  // NOLINT
     }
 }
 
+TEST_F(RTLModuleTest, test_resolve_handles) {  // NOLINT
+    std::vector<std::string> names = {"parent_mod.a", "parent_mod.inst1.b",
+                                      "parent_mod.inst2.array[1][2]", "parent_mod.inst1.$parent.b",
+                                      "unknown_mod.c"};
+    hgdb::ThreadPool pool(4);
+    uint64_t last_done = 0;
+    auto num_resolved = client->resolve_handles(names, pool, [&](uint64_t done, uint64_t total) {
+        EXPECT_GT(done, last_done);
+        EXPECT_EQ(total, names.size());
+        last_done = done;
+    });
+    EXPECT_EQ(num_resolved, 4);
+    EXPECT_EQ(last_done, names.size());
+
+    // same handles as resolving them one by one
+    auto *a = client->get_handle("parent_mod.a");
+    EXPECT_NE(a, nullptr);
+    EXPECT_EQ(a, vpi().vpi_handle_by_name(const_cast<char *>("top.dut.a"), nullptr));
+    EXPECT_EQ(client->get_handle("parent_mod.b"),
+              vpi().vpi_handle_by_name(const_cast<char *>("top.dut.b"), nullptr));
+    EXPECT_EQ(client->get_value("parent_mod.inst2.array[1][2]"), 0);
+}
+
+TEST_F(RTLModuleTest, test_get_values) {  // NOLINT
+    auto &mock_vpi = vpi();
+    auto *a = client->get_handle("parent_mod.a");
+    auto *b = client->get_handle("parent_mod.inst1.b");
+    auto *slice = client->get_handle("parent_mod.a[3:0]");
+    std::vector<vpiHandle> handles = {a, nullptr, b, slice};
+    std::vector<std::optional<int64_t>> values(handles.size());
+    client->get_values(handles, values);
+    EXPECT_EQ(mock_vpi.batch_reads(), 1);
+    EXPECT_EQ(*values[0], a_value);
+    EXPECT_FALSE(values[1]);
+    EXPECT_EQ(*values[2], b_value);
+    EXPECT_EQ(*values[3], a_value & 0xF);
+
+    // values already in the snapshot are not read again
+    client->set_use_value_snapshot(true);
+    client->next_value_snapshot();
+    client->get_values(handles, values);
+    EXPECT_EQ(mock_vpi.batch_reads(), 2);
+    client->get_values(handles, values);
+    EXPECT_EQ(mock_vpi.batch_reads(), 2);
+    EXPECT_EQ(*values[3], a_value & 0xF);
+}
+
+TEST_F(RTLModuleTest, test_get_wide_value) {  // NOLINT
+    auto &mock_vpi = vpi();
+    auto *handle = client->get_handle("parent_mod.inst1.b");
+    hgdb::WideValue value;
+    value.words = {0xDEADBEEF00000001, 0x1234, 0, 0, 0, 0, 0, 0};
+    mock_vpi.set_signal_value(handle, value, 80);
+    hgdb::WideValue result;
+    EXPECT_TRUE(client->get_wide_value(handle, result));
+    // bits beyond the signal width are not read
+    value.words[1] &= 0xFFFF;
+    EXPECT_EQ(result, value);
+    EXPECT_EQ(result.hex_str(), "0x1234DEADBEEF00000001");
+    EXPECT_FALSE(client->get_wide_value(nullptr, result));
+}
+
 TEST_F(RTLModuleTest, test_set_value) {  // NOLINT
     auto constexpr value = 42;
     auto res = client->set_value("parent_mod.a", value);
@@ -293,6 +394,40 @@ TEST_F(RTLModuleTest, test_set_value) {  // NOLINT
     EXPECT_EQ(*v, value);
 }
 
+TEST_F(RTLModuleTest, test_value_snapshot) {  // NOLINT
+    auto &mock_vpi = vpi();
+    auto *handle = client->get_handle("parent_mod.a");
+    client->set_use_value_snapshot(true);
+    client->next_value_snapshot();
+    auto v = client->get_value(handle);
+    EXPECT_EQ(*v, a_value);
+    // values are frozen within the same cycle
+    mock_vpi.set_signal_value(handle, a_value + 1);
+    v = client->get_value(handle);
+    EXPECT_EQ(*v, a_value);
+    // new cycle
+    client->next_value_snapshot();
+    v = client->get_value(handle);
+    EXPECT_EQ(*v, a_value + 1);
+    // setting value invalidates the entry
+    EXPECT_TRUE(client->set_value(handle, a_value + 2));
+    v = client->get_value(handle);
+    EXPECT_EQ(*v, a_value + 2);
+
+    // large amount of signals forces the snapshot to grow
+    std::vector<vpiHandle> handles;
+    for (auto i = 0; i < 2000; i++) {
+        auto *h = mock_vpi.get_new_handle();
+        mock_vpi.set_signal_value(h, i);
+        handles.emplace_back(h);
+        EXPECT_EQ(*client->get_value(h), i);
+    }
+    client->next_value_snapshot();
+    for (auto i = 0; i < 2000; i++) {
+        EXPECT_EQ(*client->get_value(handles[i]), i);
+    }
+}
+
 TEST_F(RTLModuleTest, test_get_design) {  // NOLINT
     auto mapping = client->get_mapping();
     EXPECT_EQ(mapping.first, "parent_mod");
@@ -18,6 +18,26 @@ public:
     auto time() const { return time_; }
 };
 
+namespace hgdb {
+
+class SchedulerTestFriend {
+public:
+    explicit SchedulerTestFriend(Scheduler *scheduler) : scheduler_(scheduler) {}
+
+    void set_clock_names(const std::vector<std::string> &names) {
+        scheduler_->clock_names_ = names;
+    }
+    auto compute_clock_domain(const std::string &instance_name) const {
+        return scheduler_->compute_clock_domain(instance_name);
+    }
+    auto num_step_breakpoints() const { return scheduler_->step_breakpoints_.size(); }
+
+private:
+    Scheduler *scheduler_;
+};
+
+}  // namespace hgdb
+
 /*
  * module child;
  * logic[31:0] a;
@@ -103,7 +123,6 @@ TEST_F(ScheduleTestReverse, test_reverse_continue) {  // NOLINT
     for (auto const &bp : breakpoints) {
         scheduler.add_breakpoint(bp, bp);
     }
-    scheduler.reorder_breakpoints();
 
     auto bps = scheduler.next_breakpoints();
     EXPECT_EQ(bps.size(), 2);
@@ -239,7 +258,6 @@ TEST_F(ScheduleTestNoReverse, test_continue) {  // NOLINT
     for (auto const &bp : breakpoints) {
         scheduler.add_breakpoint(bp, bp);
     }
-    scheduler.reorder_breakpoints();
 
     auto bps = scheduler.next_breakpoints();
     EXPECT_EQ(bps.size(), 2);
@@ -254,3 +272,412 @@ TEST_F(ScheduleTestNoReverse, test_continue) {  // NOLINT
     bps = scheduler.next_breakpoints();
     EXPECT_TRUE(bps.empty());
 }
+
+TEST_F(ScheduleTestReverse, cached_results_cleared_on_rewind) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::BreakPointOnly);
+    EXPECT_TRUE(scheduler.use_cached_results());
+
+    auto breakpoints = db_->get_breakpoints("test.sv");
+    for (auto const &bp : breakpoints) {
+        scheduler.add_breakpoint(bp, bp);
+    }
+
+    auto bps = scheduler.next_breakpoints();
+    EXPECT_FALSE(bps.empty());
+    for (auto *bp : bps) bp->cached_result = 1;
+    scheduler.clear_cached_results();
+    for (auto const *bp : bps) EXPECT_FALSE(bp->cached_result);
+
+    for (auto *bp : bps) bp->cached_result = 1;
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::ReverseBreakpointOnly);
+    EXPECT_FALSE(scheduler.use_cached_results());
+    for (auto const *bp : bps) EXPECT_FALSE(bp->cached_result);
+}
+
+TEST_F(ScheduleTestNoReverse, time_window_per_type) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    using Type = hgdb::DebugBreakPoint::Type;
+
+    auto bp = *db_->get_breakpoint(0);
+    scheduler.add_breakpoint(bp, bp);
+    scheduler.set_time_window(bp.id, Type::normal, {.start = 10, .end = 20});
+    // data breakpoints share the id with the line breakpoint
+    EXPECT_NE(scheduler.add_data_breakpoint("a", "", bp, false, {.start = 30, .end = 40}),
+              nullptr);
+    EXPECT_NE(scheduler.add_data_breakpoint("b", "", bp, false, {.start = 50}), nullptr);
+    scheduler.set_time_window(bp.id, Type::normal, {.start = 15, .end = 20});
+
+    auto bps = scheduler.get_current_breakpoints();
+    EXPECT_EQ(bps.size(), 3);
+    for (auto const *b : bps) {
+        if (b->type == Type::normal) {
+            EXPECT_EQ(b->time_window.start, 15);
+        } else if (b->target_rtl_var_name == "a") {
+            EXPECT_EQ(b->time_window.start, 30);
+            EXPECT_EQ(b->time_window.end, 40);
+        } else {
+            EXPECT_EQ(b->target_rtl_var_name, "b");
+            EXPECT_EQ(b->time_window.start, 50);
+        }
+    }
+}
+
+TEST_F(ScheduleTestNoReverse, hit_condition_per_type) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    using Type = hgdb::DebugBreakPoint::Type;
+
+    auto bp = *db_->get_breakpoint(0);
+    EXPECT_NE(scheduler.add_data_breakpoint("a", "", bp, false), nullptr);
+    auto condition = *hgdb::HitCountCondition::parse("== 3");
+    // adding the line breakpoint again later doesn't touch the data breakpoint either
+    for (auto i = 0; i < 2; i++) {
+        scheduler.add_breakpoint(bp, bp);
+        scheduler.set_hit_condition(bp.id, Type::normal, condition);
+    }
+
+    auto bps = scheduler.get_current_breakpoints();
+    EXPECT_EQ(bps.size(), 2);
+    for (auto const *b : bps) {
+        if (b->type == Type::normal) {
+            EXPECT_EQ(b->hit_condition.kind, hgdb::HitCountCondition::Kind::equal);
+            EXPECT_EQ(b->hit_condition.count, 3);
+        } else {
+            EXPECT_EQ(b->type, Type::data);
+            EXPECT_EQ(b->hit_condition.kind, hgdb::HitCountCondition::Kind::none);
+        }
+    }
+}
+
+TEST_F(ScheduleTestNoReverse, insert_remove_order) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+
+    auto breakpoints = db_->get_breakpoints("test.sv");
+    EXPECT_EQ(breakpoints.size(), 4);
+    // inserted against the execution order
+    for (auto i = breakpoints.size(); i > 0; i--) {
+        scheduler.add_breakpoint(breakpoints[i - 1], breakpoints[i - 1]);
+    }
+    // removing one in the middle of an evaluation cycle
+    auto bps = scheduler.next_breakpoints();
+    EXPECT_EQ(bps.size(), 2);
+    for (auto const *bp : bps) EXPECT_EQ(bp->line_num, 1);
+    auto removed = std::find_if(breakpoints.begin(), breakpoints.end(),
+                                [](auto const &bp) { return bp.line_num == 2; });
+    scheduler.remove_breakpoint(*removed, hgdb::DebugBreakPoint::Type::normal);
+
+    bps = scheduler.next_breakpoints();
+    EXPECT_EQ(bps.size(), 1);
+    EXPECT_EQ(bps[0]->line_num, 2);
+    EXPECT_NE(bps[0]->id, removed->id);
+    bps = scheduler.next_breakpoints();
+    EXPECT_TRUE(bps.empty());
+
+    // adding it back keeps the order
+    scheduler.add_breakpoint(*removed, *removed);
+    scheduler.start_breakpoint_evaluation();
+    bps = scheduler.next_breakpoints();
+    EXPECT_EQ(bps.size(), 2);
+    for (auto const *bp : bps) EXPECT_EQ(bp->line_num, 1);
+    bps = scheduler.next_breakpoints();
+    EXPECT_EQ(bps.size(), 2);
+    for (auto const *bp : bps) EXPECT_EQ(bp->line_num, 2);
+}
+
+TEST_F(ScheduleTestNoReverse, remove_data_breakpoint_watches) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+
+    auto bp0 = *db_->get_breakpoint(0);
+    auto bp1 = *db_->get_breakpoint(1);
+    auto *a = scheduler.add_data_breakpoint("a", "", bp0, false);
+    auto *b = scheduler.add_data_breakpoint("b", "", bp0, false);
+    // same signal as a, sharing its watch
+    auto *a1 = scheduler.add_data_breakpoint("a", "", bp1, false);
+    ASSERT_TRUE(a && b && a1);
+    a->watch_id = 1;
+    b->watch_id = 2;
+    a1->watch_id = 1;
+
+    // every removed instance reports its watch, except the one still in use
+    auto watches = scheduler.remove_data_breakpoint(bp0.id);
+    EXPECT_EQ(watches.size(), 1);
+    EXPECT_EQ(watches[0].first, 0);
+    EXPECT_EQ(watches[0].second, 2);
+
+    watches = scheduler.remove_data_breakpoint(bp1.id);
+    EXPECT_EQ(watches.size(), 1);
+    EXPECT_EQ(watches[0].second, 1);
+    EXPECT_TRUE(scheduler.get_current_breakpoints().empty());
+}
+
+TEST_F(ScheduleTestNoReverse, trigger_symbols) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    auto *rtl = namespaces_.default_rtl();
+
+    auto bp = *db_->get_breakpoint(0);
+    // repeated tokens are only watched once
+    bp.trigger = "a b  a clk b";
+    auto *debug_bp = scheduler.add_breakpoint(bp, bp);
+    ASSERT_NE(debug_bp, nullptr);
+    EXPECT_EQ(debug_bp->trigger_names, (std::vector<std::string>{"a", "b", "clk"}));
+    EXPECT_EQ(debug_bp->trigger_values.size(), 3);
+    EXPECT_FALSE(debug_bp->trigger_values_valid);
+    // handles are parallel to the names
+    ASSERT_EQ(debug_bp->trigger_handles.size(), 3);
+    for (auto i = 0u; i < 3; i++) {
+        auto name = fmt::format("top.inst0.{0}", debug_bp->trigger_names[i]);
+        EXPECT_EQ(debug_bp->trigger_handles[i], rtl->get_handle(name));
+    }
+
+    // a symbol that can't be resolved leaves the breakpoint without triggers
+    auto bp_missing = *db_->get_breakpoint(1);
+    bp_missing.trigger = "a missing";
+    debug_bp = scheduler.add_breakpoint(bp_missing, bp_missing);
+    ASSERT_NE(debug_bp, nullptr);
+    EXPECT_TRUE(debug_bp->trigger_names.empty());
+    EXPECT_TRUE(debug_bp->trigger_handles.empty());
+    EXPECT_TRUE(debug_bp->trigger_values.empty());
+}
+
+TEST_F(ScheduleTestNoReverse, clock_domain) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    hgdb::SchedulerTestFriend scheduler_friend(&scheduler);
+    auto domain = [&](const std::string &instance_name) {
+        return scheduler_friend.compute_clock_domain(instance_name);
+    };
+
+    // a single clock doesn't partition anything
+    scheduler_friend.set_clock_names({"top.clk"});
+    EXPECT_EQ(domain("top.inst0"), std::nullopt);
+
+    // nested scopes. the closest enclosing scope wins
+    scheduler_friend.set_clock_names({"top.clk", "top.inst0.clk"});
+    EXPECT_EQ(domain("top"), 0);
+    EXPECT_EQ(domain("top.inst0"), 1);
+    EXPECT_EQ(domain("top.inst0.child"), 1);
+    EXPECT_EQ(domain("top.inst1"), 0);
+    // only whole scope names match
+    EXPECT_EQ(domain("top.inst01"), 0);
+    EXPECT_EQ(domain("dut"), std::nullopt);
+
+    // sibling scopes
+    scheduler_friend.set_clock_names({"top.inst0.clk", "top.inst1.clk"});
+    EXPECT_EQ(domain("top.inst0"), 0);
+    EXPECT_EQ(domain("top.inst1.child"), 1);
+    EXPECT_EQ(domain("top"), std::nullopt);
+
+    // two clocks in the same scope
+    scheduler_friend.set_clock_names({"top.clk_a", "top.clk_b"});
+    EXPECT_EQ(domain("top.inst0"), std::nullopt);
+    scheduler_friend.set_clock_names({"top.clk_a", "top.clk_b", "top.inst1.clk"});
+    EXPECT_EQ(domain("top.inst0"), std::nullopt);
+    EXPECT_EQ(domain("top.inst1"), 2);
+
+    // top-level clocks enclose every instance
+    scheduler_friend.set_clock_names({"clk_a", "clk_b"});
+    EXPECT_EQ(domain("top.inst0"), std::nullopt);
+    scheduler_friend.set_clock_names({"clk", "top.inst0.clk"});
+    EXPECT_EQ(domain("top.inst0"), 1);
+    EXPECT_EQ(domain("top.inst1"), 0);
+}
+
+TEST_F(ScheduleTestNoReverse, clock_domain_evaluation) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+
+    auto breakpoints = db_->get_breakpoints("test.sv");
+    EXPECT_EQ(breakpoints.size(), 4);
+    for (auto const &bp : breakpoints) {
+        auto *debug_bp = scheduler.add_breakpoint(bp, bp);
+        ASSERT_NE(debug_bp, nullptr);
+        // one domain per instance
+        debug_bp->clock_domain = debug_bp->instance_id;
+    }
+
+    auto evaluated_ids = [&](std::optional<uint32_t> clock_domain) {
+        scheduler.start_breakpoint_evaluation(clock_domain);
+        std::set<uint32_t> ids;
+        while (true) {
+            auto bps = scheduler.next_breakpoints();
+            if (bps.empty()) break;
+            for (auto const *bp : bps) ids.emplace(bp->id);
+        }
+        return ids;
+    };
+    EXPECT_EQ(evaluated_ids(0), (std::set<uint32_t>{0, 1}));
+    EXPECT_EQ(evaluated_ids(1), (std::set<uint32_t>{10, 11}));
+    EXPECT_EQ(evaluated_ids(std::nullopt), (std::set<uint32_t>{0, 1, 10, 11}));
+}
+
+TEST_F(ScheduleTestNoReverse, change_driven_dependencies) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    auto *rtl = namespaces_.default_rtl();
+    auto *vpi = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    auto num_dependency_callbacks = [rtl]() {
+        auto names = rtl->callback_names();
+        return std::count_if(names.begin(), names.end(), [](auto const &name) {
+            return name.starts_with("Dependency");
+        });
+    };
+    scheduler.set_change_driven(true);
+
+    // both read a from inst0
+    auto bp0 = *db_->get_breakpoint(0);
+    auto bp1 = *db_->get_breakpoint(1);
+    bp0.condition = bp1.condition = "a == 1";
+    auto *debug_bp0 = scheduler.add_breakpoint(bp0, bp0);
+    auto *debug_bp1 = scheduler.add_breakpoint(bp1, bp1);
+    ASSERT_NE(debug_bp0, nullptr);
+    ASSERT_NE(debug_bp1, nullptr);
+    EXPECT_TRUE(debug_bp0->change_driven);
+    ASSERT_EQ(debug_bp0->dependencies.size(), 1);
+    EXPECT_EQ(debug_bp0->dependencies, debug_bp1->dependencies);
+    EXPECT_EQ(num_dependency_callbacks(), 1);
+    // b from inst1
+    auto bp10 = *db_->get_breakpoint(10);
+    bp10.condition = "b == 1";
+    auto *debug_bp10 = scheduler.add_breakpoint(bp10, bp10);
+    ASSERT_NE(debug_bp10, nullptr);
+    EXPECT_TRUE(debug_bp10->change_driven);
+    EXPECT_EQ(num_dependency_callbacks(), 2);
+
+    // a value change only invalidates results that depend on it
+    debug_bp0->cached_result = debug_bp1->cached_result = debug_bp10->cached_result = 1;
+    vpi->set_signal_value(debug_bp0->dependencies[0], 2);
+    EXPECT_FALSE(debug_bp0->cached_result);
+    EXPECT_FALSE(debug_bp1->cached_result);
+    EXPECT_EQ(debug_bp10->cached_result, 1);
+
+    // the callback is removed with the last breakpoint that reads the signal
+    scheduler.remove_breakpoint(bp0, hgdb::DebugBreakPoint::Type::normal);
+    EXPECT_EQ(num_dependency_callbacks(), 2);
+    scheduler.remove_breakpoint(bp1, hgdb::DebugBreakPoint::Type::normal);
+    EXPECT_EQ(num_dependency_callbacks(), 1);
+    scheduler.remove_breakpoint(bp10, hgdb::DebugBreakPoint::Type::normal);
+    EXPECT_EQ(num_dependency_callbacks(), 0);
+}
+
+TEST_F(ScheduleTestNoReverse, change_driven_fallback) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    auto *rtl = namespaces_.default_rtl();
+    auto *vpi = reinterpret_cast<MockVPIProvider *>(rtl->vpi().get());
+    scheduler.set_change_driven(true);
+
+    // $time changes every cycle
+    auto bp = *db_->get_breakpoint(0);
+    bp.condition = "a == 1 && $time > 5";
+    auto *debug_bp = scheduler.add_breakpoint(bp, bp);
+    ASSERT_NE(debug_bp, nullptr);
+    EXPECT_FALSE(debug_bp->change_driven);
+    EXPECT_TRUE(debug_bp->dependencies.empty());
+    EXPECT_TRUE(rtl->callback_names().empty());
+
+    // the simulator refuses value change callbacks
+    vpi->set_value_change_cb_enabled(false);
+    bp = *db_->get_breakpoint(10);
+    bp.condition = "a == 1";
+    debug_bp = scheduler.add_breakpoint(bp, bp);
+    ASSERT_NE(debug_bp, nullptr);
+    EXPECT_FALSE(debug_bp->change_driven);
+    EXPECT_TRUE(debug_bp->dependencies.empty());
+    EXPECT_TRUE(rtl->callback_names().empty());
+}
+
+TEST_F(ScheduleTestNoReverse, step_breakpoint_cache) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    hgdb::SchedulerTestFriend scheduler_friend(&scheduler);
+    auto const bp_ordering = db_->execution_bp_orders();
+    auto const num_namespaces = namespaces_.size();
+
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepOver);
+    std::vector<std::vector<hgdb::DebugBreakPoint *>> steps;
+    for (auto i = 0u; i < bp_ordering.size(); i++) {
+        auto bps = scheduler.next_breakpoints();
+        ASSERT_EQ(bps.size(), num_namespaces);
+        for (auto const *bp : bps) {
+            EXPECT_EQ(bp->id, bp_ordering[i]);
+            EXPECT_TRUE(bp->enable_expr->correct());
+        }
+        steps.emplace_back(std::move(bps));
+    }
+    EXPECT_EQ(scheduler_friend.num_step_breakpoints(), bp_ordering.size());
+
+    // stepping over the same breakpoints again reuses the validated instances
+    scheduler.start_breakpoint_evaluation();
+    for (auto const &step : steps) {
+        EXPECT_EQ(scheduler.next_breakpoints(), step);
+    }
+    EXPECT_EQ(scheduler_friend.num_step_breakpoints(), bp_ordering.size());
+
+    scheduler.clear();
+    EXPECT_EQ(scheduler_friend.num_step_breakpoints(), 0);
+}
+
+TEST_F(ScheduleTestNoReverse, step_ordering_ends) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    auto *vpi = reinterpret_cast<MockVPIProvider *>(namespaces_.default_rtl()->vpi().get());
+    vpi->set_time(10);
+    vpi->set_rewind_enabled(false);
+    auto const bp_ordering = db_->execution_bp_orders();
+    ASSERT_GT(bp_ordering.size(), 1);
+
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepOver);
+    for (auto const id : bp_ordering) {
+        auto bps = scheduler.next_breakpoints();
+        ASSERT_EQ(bps.size(), 1);
+        EXPECT_EQ(bps[0]->id, id);
+    }
+    // nothing after the last one
+    EXPECT_TRUE(scheduler.next_breakpoints().empty());
+
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepBack);
+    scheduler.start_breakpoint_evaluation();
+    // can't step back without a current breakpoint
+    EXPECT_TRUE(scheduler.next_breakpoints().empty());
+
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepOver);
+    scheduler.start_breakpoint_evaluation();
+    for (auto i = 0u; i < bp_ordering.size(); i++) scheduler.next_breakpoints();
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepBack);
+    for (auto i = bp_ordering.size() - 1; i > 0; i--) {
+        auto bps = scheduler.next_breakpoints();
+        ASSERT_EQ(bps.size(), 1);
+        EXPECT_EQ(bps[0]->id, bp_ordering[i - 1]);
+    }
+    // stuck at the first one since the simulator can't go back in time
+    auto bps = scheduler.next_breakpoints();
+    ASSERT_EQ(bps.size(), 1);
+    EXPECT_EQ(bps[0]->id, bp_ordering.front());
+    EXPECT_EQ(vpi->get_time(), 10);
+}
+
+TEST_F(ScheduleTestReverse, step_back_first_breakpoint) {  // NOLINT
+    bool val1 = false, val2 = true;
+    hgdb::Scheduler scheduler(namespaces_, db_.get(), val1, val2);
+    auto *vpi = reinterpret_cast<ReverseMockVPIProvider *>(namespaces_.default_rtl()->vpi().get());
+    vpi->set_time(10);
+    auto const bp_ordering = db_->execution_bp_orders();
+
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepOver);
+    auto bps = scheduler.next_breakpoints();
+    ASSERT_EQ(bps.size(), 1);
+    EXPECT_EQ(bps[0]->id, bp_ordering.front());
+    // stepping back from the first one goes to the last one of the previous cycle
+    scheduler.set_evaluation_mode(hgdb::Scheduler::EvaluationMode::StepBack);
+    bps = scheduler.next_breakpoints();
+    ASSERT_EQ(bps.size(), 1);
+    EXPECT_EQ(bps[0]->id, bp_ordering.back());
+    EXPECT_EQ(vpi->time(), 10 - 2);
+}
@@ -1,6 +1,7 @@
 #include <thread>
 #include <chrono>
 
+#include "../src/concurrent_map.hh"
 #include "../src/thread.hh"
 #include "gtest/gtest.h"
 
@@ -18,4 +19,61 @@ TEST(thread, wait_ready) {  // NOLINT
     std::this_thread::sleep_for(10ms);
     EXPECT_TRUE(state);
     t.join();
-}
\ No newline at end of file
+}
+
+TEST(thread, pool_parallel_for) {  // NOLINT
+    hgdb::ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+    // reuse the same pool across many rounds, similar to clock edges
+    for (auto round = 0; round < 100; round++) {
+        constexpr auto size = 1000u;
+        std::vector<std::atomic<int>> visited(size);
+        pool.parallel_for(size, 7, [&visited](uint64_t start, uint64_t end) {
+            for (auto i = start; i < end; i++) visited[i]++;
+        });
+        for (auto const &v : visited) {
+            EXPECT_EQ(v.load(), 1);
+        }
+    }
+
+    // single worker runs in the calling thread
+    hgdb::ThreadPool single(1);
+    auto id = std::this_thread::get_id();
+    single.parallel_for(100, 1,
+                        [id](uint64_t, uint64_t) { EXPECT_EQ(std::this_thread::get_id(), id); });
+}
+
+TEST(thread, concurrent_map) {  // NOLINT
+    hgdb::ConcurrentMap<std::string, int> map;
+    EXPECT_EQ(map.find("a"), nullptr);
+    auto [value, inserted] = map.emplace("a", 1);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*value, 1);
+    // first insert wins
+    auto [existing, inserted_again] = map.emplace("a", 2);
+    EXPECT_FALSE(inserted_again);
+    EXPECT_EQ(existing, value);
+
+    // readers race with a writer that keeps growing the table. values never move
+    constexpr auto size = 10000;
+    std::atomic<bool> done = false;
+    std::vector<std::thread> readers;
+    for (auto i = 0; i < 4; i++) {
+        readers.emplace_back([&map, &done, value = value]() {
+            while (!done.load()) {
+                EXPECT_EQ(map.find("a"), value);
+                auto const *v = map.find("42");
+                if (v) EXPECT_EQ(*v, 42);
+            }
+        });
+    }
+    for (auto i = 0; i < size; i++) {
+        map.emplace(std::to_string(i), i);
+    }
+    done = true;
+    for (auto &t : readers) t.join();
+    EXPECT_EQ(map.size(), size + 1);
+    for (auto i = 0; i < size; i++) {
+        EXPECT_EQ(*map.find(std::to_string(i)), i);
+    }
+}
@@ -34,6 +34,17 @@ public:
             } else if (value_p->format == vpiBinStrVal) {
                 str_buffer_ = fmt::format("{0:b}", signal_values_.at(expr));
                 value_p->value.str = const_cast<char *>(str_buffer_.c_str());
+            } else if (value_p->format == vpiVectorVal) {
+                auto pos = wide_values_.find(expr);
+                auto value = pos != wide_values_.end() ? pos->second
+                                                       : hgdb::WideValue(signal_values_.at(expr));
+                vector_buffer_.resize(hgdb::WideValue::num_words * 2);
+                for (auto i = 0u; i < vector_buffer_.size(); i++) {
+                    vector_buffer_[i].aval =
+                        static_cast<PLI_UINT32>(value.words[i / 2] >> (32 * (i % 2)));
+                    vector_buffer_[i].bval = 0;
+                }
+                value_p->value.vector = vector_buffer_.data();
             }
         } else {
             if (value_p->format == vpiIntVal) {
@@ -44,6 +55,23 @@ public:
         }
     }
 
+    void vpi_get_values(std::span<const vpiHandle> handles,
+                        std::span<s_vpi_value> values) override {
+        batch_reads_++;
+        for (auto i = 0u; i < handles.size(); i++) {
+            auto &value = values[i];
+            auto pos = signal_values_.find(handles[i]);
+            if (value.format == vpiIntVal) [[likely]] {
+                value.value.integer =
+                    pos != signal_values_.end() ? static_cast<int>(pos->second) : 0;
+            } else {
+                vpi_get_value(handles[i], &value);
+            }
+        }
+    }
+
+    [[nodiscard]] uint64_t batch_reads() const { return batch_reads_; }
+
     void stop() {
         // need to find debugger instance
         // assume there is no shutdown events
@@ -71,6 +99,9 @@ public:
                 }
             }
         } else if (property == vpiSize) {
+            if (signal_widths_.find(object) != signal_widths_.end()) {
+                return signal_widths_.at(object);
+            }
             // every signal is 32-bit for now
             // if it's clock object then it's 1
             // otherwise it's 32
@@ -189,6 +220,7 @@ public:
     }
 
     vpiHandle vpi_register_cb(p_cb_data cb_data_p) override {
+        if (cb_data_p->reason == cbValueChange && !value_change_cb_allowed_) return nullptr;
         auto *handle = get_new_handle();
         callbacks_.emplace(handle, cb_data{.data = *cb_data_p});
         return handle;
@@ -310,6 +342,21 @@ public:
         }
     }
 
+    // one-shot callbacks, which are released once they fire
+    void trigger_next_sim_time() {
+        std::vector<s_cb_data> cbs;
+        for (auto &iter : callbacks_) {
+            auto &cb_data = iter.second;
+            if (cb_data.deleted || cb_data.data.reason != cbNextSimTime) continue;
+            cb_data.deleted = true;
+            cbs.emplace_back(cb_data.data);
+        }
+        // callbacks may register new ones
+        for (auto &cb_data : cbs) {
+            cb_data.cb_rtn(&cb_data);
+        }
+    }
+
     std::vector<s_cb_data> get_cb_funcs(uint32_t reason) const {
         std::vector<s_cb_data> result;
         for (auto const &iter : callbacks_) {
@@ -342,10 +389,17 @@ public:
             }
         }
     }
+    // signals wider than 64 bits
+    void set_signal_value(vpiHandle handle, const hgdb::WideValue &value, uint32_t width) {
+        signal_widths_[handle] = width;
+        wide_values_[handle] = value;
+        set_signal_value(handle, static_cast<int64_t>(value.words[0]));
+    }
     void set_top(vpiHandle top) { top_ = top; }
 
     [[nodiscard]] const std::vector<uint32_t> &vpi_ops() const { return vpi_ops_; }
     void set_rewind_enabled(bool value) { rewind_allowed_ = value; }
+    void set_value_change_cb_enabled(bool value) { value_change_cb_allowed_ = value; }
 
     bool has_defname() override { return true; }
 
@@ -361,6 +415,9 @@ protected:
     std::unordered_map<vpiHandle, std::unordered_set<vpiHandle>> module_hierarchy_;
     std::unordered_map<vpiHandle, std::unordered_set<vpiHandle>> module_signals_;
     std::unordered_map<vpiHandle, int64_t> signal_values_;
+    std::unordered_map<vpiHandle, hgdb::WideValue> wide_values_;
+    std::unordered_map<vpiHandle, uint32_t> signal_widths_;
+    std::vector<s_vpi_vecval> vector_buffer_;
     // for arrays
     std::unordered_map<vpiHandle, std::vector<vpiHandle>> array_handles_;
 
@@ -371,6 +428,7 @@ protected:
     std::unordered_map<vpiHandle, cb_data> callbacks_;
 
     std::vector<uint32_t> vpi_ops_;
+    std::atomic<uint64_t> batch_reads_ = 0;
 
     std::vector<std::string> argv_str_;
     std::vector<char *> argv_;
@@ -379,6 +437,7 @@ protected:
     vpiHandle top_ = nullptr;
 
     bool rewind_allowed_ = true;
+    bool value_change_cb_allowed_ = true;
 
 public:
     constexpr static auto product = "RTLMock";
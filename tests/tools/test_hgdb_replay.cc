@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <filesystem>
 
 #include "../../tools/hgdb-replay/engine.hh"
@@ -88,6 +89,13 @@ TEST(vcd, vcd_parse) {  // NOLINT
     EXPECT_EQ(*value, "1");
     value = db.get_signal_value(*db.get_signal_id("top.clk"), 10);
     EXPECT_EQ(*value, "1");
+
+    // posedge index
+    auto posedges = db.get_value_change_times(*db.get_signal_id("top.clk"), "1");
+    EXPECT_EQ(posedges.size(), 10);
+    EXPECT_EQ(posedges.front(), 10);
+    EXPECT_EQ(posedges.back(), 190);
+    EXPECT_TRUE(std::is_sorted(posedges.begin(), posedges.end()));
 }
 
 int cycle_count(p_cb_data cb_data) {
@@ -311,6 +319,35 @@ TEST(replay, array_waveform4) {  // NOLINT
     }
 }
 
+TEST(replay, wide_signal_waveform7) {  // NOLINT
+    change_cwd();
+    auto db = std::make_unique<hgdb::vcd::VCDDatabase>("waveform7.vcd");
+    auto vpi_ = std::make_unique<hgdb::replay::ReplayVPIProvider>(std::move(db));
+    auto *vpi = vpi_.get();
+    hgdb::RTLSimulatorClient rtl(std::move(vpi_));
+
+    auto *wide = rtl.get_handle("top.wide");
+    EXPECT_NE(wide, nullptr);
+    EXPECT_EQ(rtl.get_signal_width(wide), 128);
+
+    hgdb::WideValue value;
+    vpi->set_timestamp(0);
+    EXPECT_TRUE(rtl.get_wide_value(wide, value));
+    EXPECT_TRUE(value.zero());
+
+    vpi->set_timestamp(10);
+    EXPECT_TRUE(rtl.get_wide_value(wide, value));
+    EXPECT_EQ(value.words[0], 2);
+    EXPECT_EQ(value.words[1], 1);
+    EXPECT_EQ(value.words[2], 0);
+
+    vpi->set_timestamp(20);
+    EXPECT_TRUE(rtl.get_wide_value(wide, value));
+    EXPECT_EQ(value.words[0], 5);
+    EXPECT_EQ(value.words[1], 0x8000'0000'0000'0000ull);
+    EXPECT_EQ(value.words[2], 0);
+}
+
 #ifdef USE_FSDB
 bool inside_valgrind() {
     auto *ld_preload = std::getenv("LD_PRELOAD");
@@ -113,6 +113,42 @@ def test_replay3(start_server, find_free_port, get_tools_vector_dir):
     s.kill()
 
 
+def test_replay3_find_when(start_server, find_free_port, get_tools_vector_dir):
+    vector_dir = get_tools_vector_dir()
+    vcd_path = os.path.join(vector_dir, "waveform3.vcd")
+    port = find_free_port()
+    s = start_server(port, ("tools", "hgdb-replay", "hgdb-replay"), args=[vcd_path], use_plus_arg=False)
+    if s is None:
+        pytest.skip("hgdb-deplay not available")
+    sv = os.path.join(vector_dir, "waveform3.sv")
+    with tempfile.TemporaryDirectory() as tempdir:
+        db = os.path.join(tempdir, "debug.db")
+        write_out_db3(db, sv)
+
+        async def test_logic():
+            client = hgdb.client.HGDBClient("ws://localhost:{0}".format(port), db)
+            await client.connect()
+            time.sleep(0.1)
+            # the replay hasn't started yet
+            times = await client.find_when("out == 2", breakpoint_id=0)
+            assert times == [25]
+            await client.set_breakpoint(sv, get_line_num(sv, "        out <= in;"))
+            await client.continue_()
+            bp = await client.recv()
+            assert bp["payload"]["time"] == 5
+            # searching doesn't move the replay
+            times = await client.find_when("in > out", start_time=5, limit=3, breakpoint_id=0)
+            assert times == [10, 20, 30]
+            await client.continue_()
+            bp = await client.recv()
+            assert bp["payload"]["time"] == 15
+            assert bp["payload"]["instances"][0]["local"]["out"] == "0x0"
+
+        asyncio.get_event_loop_policy().get_event_loop().run_until_complete(test_logic())
+
+    s.kill()
+
+
 def test_replay4(start_server, find_free_port, get_tools_vector_dir):
     vector_dir = get_tools_vector_dir()
     vcd_path = os.path.join(vector_dir, "waveform4.vcd")
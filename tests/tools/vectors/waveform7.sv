@@ -0,0 +1,27 @@
+// wide buses that don't fit into 64 bits
+module top;
+
+logic clk;
+logic[127:0] wide;
+
+initial begin
+    clk = 0;
+    wide = 0;
+end
+
+// clock logic
+always clk = #5 ~clk;
+
+initial begin
+    $dumpfile("waveform7.vcd");
+    $dumpvars(0, top);
+
+    @(negedge clk);
+    wide = {64'h1, 64'h2};
+    @(negedge clk);
+    wide = {64'h8000_0000_0000_0000, 64'h5};
+    @(negedge clk);
+    $finish;
+end
+
+endmodule
@@ -457,6 +457,72 @@ std::optional<uint64_t> FSDBProvider::get_prev_value_change_time(uint64_t signal
     }
 }
 
+std::vector<uint64_t> FSDBProvider::get_value_change_times(uint64_t signal_id,
+                                                           const std::string &target_value) {
+    std::vector<uint64_t> result;
+    auto signal = get_signal(signal_id);
+    if (!signal) return result;
+    auto *hdl = fsdb_->ffrCreateVCTrvsHdl(static_cast<int64_t>(signal_id));
+    if (!hdl) {
+        return result;
+    }
+    // walk the value changes once instead of jumping around the time tags
+    if (hdl->ffrGotoTheFirstVC() != FSDB_RC_SUCCESS) {
+        hdl->ffrFree();
+        return result;
+    }
+    do {
+        byte_T *vc_ptr;
+        hdl->ffrGetVC(&vc_ptr);
+        auto str = to_vcd_value(hdl->ffrGetBitSize(), hdl->ffrGetBytesPerBit(), vc_ptr);
+        if (str == target_value) {
+            fsdbTag64 time;
+            hdl->ffrGetXTag(&time);
+            uint64_t r = time.L;
+            r |= static_cast<uint64_t>(time.H) << 32;
+            result.emplace_back(r);
+        }
+    } while (hdl->ffrGotoNextVC() == FSDB_RC_SUCCESS);
+    hdl->ffrFree();
+    return result;
+}
+
+std::vector<std::pair<uint64_t, std::string>> FSDBProvider::get_value_changes(uint64_t signal_id,
+                                                                              uint64_t start,
+                                                                              uint64_t end) {
+    std::vector<std::pair<uint64_t, std::string>> result;
+    auto signal = get_signal(signal_id);
+    if (!signal) return result;
+    auto *hdl = fsdb_->ffrCreateVCTrvsHdl(static_cast<int64_t>(signal_id));
+    if (!hdl) {
+        return result;
+    }
+
+    // jump to the value at start, then walk the value changes from there
+    fsdbTag64 time;
+    time.H = static_cast<uint32_t>(start >> 32);
+    time.L = static_cast<uint32_t>(start & 0xFFFFFFFF);
+    if (hdl->ffrGotoXTag(&time) != FSDB_RC_SUCCESS) {
+        hdl->ffrFree();
+        return result;
+    }
+    auto get_vc = [hdl]() {
+        byte_T *vc_ptr;
+        hdl->ffrGetVC(&vc_ptr);
+        return to_vcd_value(hdl->ffrGetBitSize(), hdl->ffrGetBytesPerBit(), vc_ptr);
+    };
+    if (auto value = get_vc()) result.emplace_back(start, std::move(*value));
+    while (hdl->ffrGotoNextVC() == FSDB_RC_SUCCESS) {
+        hdl->ffrGetXTag(&time);
+        uint64_t r = time.L;
+        r |= static_cast<uint64_t>(time.H) << 32;
+        if (r > end) break;
+        if (auto value = get_vc()) result.emplace_back(r, std::move(*value));
+    }
+    hdl->ffrFree();
+    return result;
+}
+
 std::optional<std::string> FSDBProvider::get_instance_definition(uint64_t instance_id) const {
     if (instance_map_.find(instance_id) != instance_map_.end()) {
         // need to find a match
@@ -25,6 +25,11 @@ public:
                                                        uint64_t base_time) override;
     std::optional<uint64_t> get_prev_value_change_time(uint64_t signal_id, uint64_t base_time,
                                                        const std::string &target_value) override;
+    std::vector<uint64_t> get_value_change_times(uint64_t signal_id,
+                                                 const std::string &target_value) override;
+    std::vector<std::pair<uint64_t, std::string>> get_value_changes(uint64_t signal_id,
+                                                                    uint64_t start,
+                                                                    uint64_t end) override;
 
     [[nodiscard]] bool has_inst_definition() const override { return true; }
     std::optional<std::string> get_instance_definition(uint64_t instance_id) const override;
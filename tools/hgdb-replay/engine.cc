@@ -1,5 +1,7 @@
 #include "engine.hh"
 
+#include <algorithm>
+
 namespace hgdb::replay {
 
 using reverse_data = hgdb::AVPIProvider::rewind_data;
@@ -56,22 +58,22 @@ void EmulationEngine::on_cb_removed(const s_cb_data& cb_data) {
 
 bool EmulationEngine::on_rewound(hgdb::AVPIProvider::rewind_data* rewind_data) {
     uint64_t max_time = rewind_data->time;
-    std::vector<uint64_t> times;
-    times.reserve(rewind_data->clock_signals.size());
+    std::optional<uint64_t> next_time;
     for (auto* handle : rewind_data->clock_signals) {
         auto signal = vpi_->get_signal_id(handle);
         if (signal) {
-            auto time = vpi_->db().get_prev_value_change_time(*signal, max_time, "1");
-            if (time) {
-                times.emplace_back(*time);
+            // last posedge strictly before the current time
+            auto const& times = get_posedge_times(*signal);
+            auto pos = std::lower_bound(times.begin(), times.end(), max_time);
+            if (pos != times.begin()) {
+                auto time = *std::prev(pos);
+                if (!next_time || time > *next_time) next_time = time;
             }
         }
     }
-    if (times.empty()) return false;
-    std::sort(times.begin(), times.end());
-    auto next_time = times.back();
+    if (!next_time) return false;
     // move back a little so we can evaluate the posedge
-    change_time(next_time - 1);
+    change_time(*next_time - 1);
     return true;
 }
 
@@ -157,4 +159,13 @@ std::vector<uint64_t> EmulationEngine::get_next_changed_times() {
     return times;
 }
 
+const std::vector<uint64_t>& EmulationEngine::get_posedge_times(uint64_t signal_id) {
+    auto pos = posedge_times_.find(signal_id);
+    if (pos == posedge_times_.end()) {
+        pos = posedge_times_.emplace(signal_id, vpi_->db().get_value_change_times(signal_id, "1"))
+                  .first;
+    }
+    return pos->second;
+}
+
 }  // namespace hgdb::replay
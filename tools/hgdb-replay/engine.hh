@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <thread>
+#include <unordered_map>
 
 #include "vpi.hh"
 
@@ -20,6 +21,8 @@ private:
     ReplayVPIProvider* vpi_;
     std::atomic<uint64_t> timestamp_ = 0;
     std::map<vpiHandle, std::optional<int64_t>> watched_values_;
+    // sorted posedge times per clock signal, built the first time the clock is rewound
+    std::unordered_map<uint64_t, std::vector<uint64_t>> posedge_times_;
 
     // use for non-blocking conditions
     // normally it's for testing
@@ -36,6 +39,7 @@ private:
 
     // helper functions
     std::vector<uint64_t> get_next_changed_times();
+    const std::vector<uint64_t>& get_posedge_times(uint64_t signal_id);
 
     // when to sop running
     std::atomic<bool> running_ = true;
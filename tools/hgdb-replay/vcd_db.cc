@@ -179,6 +179,36 @@ std::optional<uint64_t> VCDDatabase::get_prev_value_change_time(uint64_t signal_
     return results[0];
 }
 
+std::vector<uint64_t> VCDDatabase::get_value_change_times(uint64_t signal_id,
+                                                          const std::string &target_value) {
+    using namespace sqlite_orm;
+    return vcd_table_->select(&VCDDBValue::time,
+                              where(c(&VCDDBValue::signal_id) == signal_id &&
+                                    c(&VCDDBValue::value) == target_value),
+                              order_by(&VCDDBValue::time).asc());
+}
+
+std::vector<std::pair<uint64_t, std::string>> VCDDatabase::get_value_changes(uint64_t signal_id,
+                                                                             uint64_t start,
+                                                                             uint64_t end) {
+    using namespace sqlite_orm;
+    std::vector<std::pair<uint64_t, std::string>> result;
+    auto value = get_signal_value(signal_id, start);
+    if (!value) return result;
+    result.emplace_back(start, *value);
+    // one range query instead of one query per value change
+    auto rows = vcd_table_->select(
+        columns(&VCDDBValue::time, &VCDDBValue::value),
+        where(c(&VCDDBValue::signal_id) == signal_id && c(&VCDDBValue::time) > start &&
+              c(&VCDDBValue::time) <= end),
+        order_by(&VCDDBValue::time).asc());
+    result.reserve(rows.size() + 1);
+    for (auto &[time, row_value] : rows) {
+        result.emplace_back(time, std::move(row_value));
+    }
+    return result;
+}
+
 std::pair<std::string, std::string> VCDDatabase::compute_instance_mapping(
     const std::unordered_set<std::string> &instance_names) {
     if (instance_names.empty()) {
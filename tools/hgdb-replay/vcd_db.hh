@@ -77,6 +77,11 @@ public:
                                                        uint64_t base_time) override;
     std::optional<uint64_t> get_prev_value_change_time(uint64_t signal_id, uint64_t base_time,
                                                        const std::string &target_value) override;
+    std::vector<uint64_t> get_value_change_times(uint64_t signal_id,
+                                                 const std::string &target_value) override;
+    std::vector<std::pair<uint64_t, std::string>> get_value_changes(uint64_t signal_id,
+                                                                    uint64_t start,
+                                                                    uint64_t end) override;
     std::pair<std::string, std::string> compute_instance_mapping(
         const std::unordered_set<std::string> &instance_names) override;
 
@@ -71,7 +71,10 @@ std::string convert_str_value(const std::string &raw_value) {
 }
 
 template <class T>
-void set_value(p_vpi_value value_p, T value, std::string &str_buffer) {
+void set_value(p_vpi_value value_p, T value, std::string &str_buffer,
+               std::vector<s_vpi_vecval> &vector_buffer) {
+    // wide reads take up to WideValue::max_width bits from the vector buffer
+    constexpr auto min_vector_size = hgdb::WideValue::max_width / 32;
     if constexpr (std::is_same<T, std::string>::value) {
         if (value_p->format == vpiIntVal) {
             // need to convert binary to actual integer values
@@ -85,6 +88,20 @@ void set_value(p_vpi_value value_p, T value, std::string &str_buffer) {
             // just use the raw string since it's already in binary format
             str_buffer = value;
             value_p->value.str = const_cast<char *>(str_buffer.c_str());
+        } else if (value_p->format == vpiVectorVal) {
+            // 32 bits per entry, least significant first. the raw string is msb first and
+            // may be shorter than the signal, in which case the upper bits are 0
+            auto size = std::max<uint64_t>((value.size() + 31) / 32, min_vector_size);
+            vector_buffer.assign(size, s_vpi_vecval{0, 0});
+            for (auto i = 0u; i < value.size(); i++) {
+                auto bit = value[value.size() - 1 - i];
+                auto &entry = vector_buffer[i / 32];
+                auto mask = 1u << (i % 32);
+                // x is encoded as aval = 1, bval = 1 and z as aval = 0, bval = 1
+                if (bit == '1' || bit == 'x') entry.aval |= mask;
+                if (bit == 'x' || bit == 'z') entry.bval |= mask;
+            }
+            value_p->value.vector = vector_buffer.data();
         }
     } else {
         if (value_p->format == vpiIntVal) {
@@ -95,6 +112,12 @@ void set_value(p_vpi_value value_p, T value, std::string &str_buffer) {
         } else if (value_p->format == vpiBinStrVal) {
             str_buffer = fmt::format("{0:b}", value);
             value_p->value.str = const_cast<char *>(str_buffer.c_str());
+        } else if (value_p->format == vpiVectorVal) {
+            auto bits = static_cast<uint64_t>(value);
+            vector_buffer.assign(min_vector_size, s_vpi_vecval{0, 0});
+            vector_buffer[0].aval = static_cast<PLI_UINT32>(bits);
+            vector_buffer[1].aval = static_cast<PLI_UINT32>(bits >> 32u);
+            value_p->value.vector = vector_buffer.data();
         }
         return;
     }
@@ -105,17 +128,17 @@ void ReplayVPIProvider::vpi_get_value(vpiHandle expr, p_vpi_value value_p) {
     // although it is unlikely (only clk signals)
     if (overridden_values_.find(expr) != overridden_values_.end()) [[unlikely]] {
         auto value = overridden_values_.at(expr);
-        set_value(value_p, value, str_buffer_);
+        set_value(value_p, value, str_buffer_, vector_buffer_);
         return;
     }
     if (signal_id_map_.find(expr) != signal_id_map_.end()) {
         auto signal_id = signal_id_map_.at(expr);
         auto value = db_->get_signal_value(signal_id, current_time_);
         if (value) {
-            set_value(value_p, *value, str_buffer_);
+            set_value(value_p, *value, str_buffer_, vector_buffer_);
         } else {
             // if unable to get value, 0 should be returned
-            set_value(value_p, 0, str_buffer_);
+            set_value(value_p, 0, str_buffer_, vector_buffer_);
         }
     } else if (array_info_.find(expr) != array_info_.end()) {
         // if there is any error, we return
@@ -130,7 +153,30 @@ void ReplayVPIProvider::vpi_get_value(vpiHandle expr, p_vpi_value value_p) {
         hi = info->raw_value.size() - lo;
         lo = hi - width;
         auto value = info->raw_value.substr(lo, hi - lo);
-        set_value(value_p, value, str_buffer_);
+        set_value(value_p, value, str_buffer_, vector_buffer_);
+    }
+}
+
+void ReplayVPIProvider::vpi_get_values(std::span<const vpiHandle> handles,
+                                       std::span<s_vpi_value> values) {
+    // the timestamp is the same for the entire batch
+    auto const time = current_time_;
+    for (auto i = 0u; i < handles.size(); i++) {
+        auto *handle = handles[i];
+        auto &value = values[i];
+        if (value.format != vpiIntVal || !overridden_values_.empty() ||
+            array_info_.find(handle) != array_info_.end()) [[unlikely]] {
+            // slow path
+            vpi_get_value(handle, &value);
+            continue;
+        }
+        value.value.integer = 0;
+        auto pos = signal_id_map_.find(handle);
+        if (pos == signal_id_map_.end()) continue;
+        auto str_value = db_->get_signal_value(pos->second, time);
+        if (str_value) {
+            set_value(&value, *str_value, str_buffer_, vector_buffer_);
+        }
     }
 }
 
@@ -398,6 +444,21 @@ bool ReplayVPIProvider::vpi_rewind(rewind_data *rewind_data) {
     return false;
 }
 
+bool ReplayVPIProvider::vpi_get_value_changes(vpiHandle handle, uint64_t start, uint64_t end,
+                                              std::vector<std::pair<uint64_t, int64_t>> &changes) {
+    // packed array slices are reconstructed from the parent signal one timestamp at a time,
+    // so they don't have a value history
+    auto signal_id = get_signal_id(handle);
+    if (!signal_id) return false;
+    auto values = db_->get_value_changes(*signal_id, start, end);
+    changes.clear();
+    changes.reserve(values.size());
+    for (auto const &[time, value] : values) {
+        changes.emplace_back(time, convert_value(value));
+    }
+    return true;
+}
+
 void ReplayVPIProvider::set_argv(int argc, char **argv) {
     argv_str_.reserve(argc);
     for (int i = 0; i < argc; i++) {
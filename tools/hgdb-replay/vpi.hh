@@ -31,6 +31,10 @@ public:
     vpiHandle vpi_register_systf(p_vpi_systf_data data) override;
     vpiHandle vpi_handle(int type, vpiHandle scope) override;
     bool vpi_rewind(rewind_data *rewind_data) override;
+    bool vpi_get_value_changes(vpiHandle handle, uint64_t start, uint64_t end,
+                               std::vector<std::pair<uint64_t, int64_t>> &changes) override;
+    void vpi_get_values(std::span<const vpiHandle> handles,
+                        std::span<s_vpi_value> values) override;
     bool has_defname() override { return db_->has_inst_definition(); }
 
     // interaction with outside world
@@ -82,6 +86,7 @@ private:
     // vpi related stuff
     char *vpi_handle_counter_ = nullptr;
     std::string str_buffer_;
+    std::vector<s_vpi_vecval> vector_buffer_;
     std::unordered_map<vpiHandle, std::vector<vpiHandle>> scan_map_;
     std::unordered_map<vpiHandle, uint64_t> scan_iter_;
     std::vector<std::string> argv_str_;
@@ -33,6 +33,37 @@ public:
     virtual std::optional<uint64_t> get_prev_value_change_time(uint64_t signal_id,
                                                                uint64_t base_time,
                                                                const std::string &target_value) = 0;
+    // all the times the signal changes to the target value, in ascending order. providers
+    // should override this if they can do better than one value change query at a time
+    virtual std::vector<uint64_t> get_value_change_times(uint64_t signal_id,
+                                                         const std::string &target_value) {
+        std::vector<uint64_t> result;
+        uint64_t time = 0;
+        while (auto next_time = get_next_value_change_time(signal_id, time)) {
+            auto value = get_signal_value(signal_id, *next_time);
+            if (value && *value == target_value) result.emplace_back(*next_time);
+            time = *next_time;
+        }
+        return result;
+    }
+    // value changes of the signal within [start, end], in ascending order. the first entry is
+    // the value at start so that the signal value is known throughout the range
+    virtual std::vector<std::pair<uint64_t, std::string>> get_value_changes(uint64_t signal_id,
+                                                                            uint64_t start,
+                                                                            uint64_t end) {
+        std::vector<std::pair<uint64_t, std::string>> result;
+        auto value = get_signal_value(signal_id, start);
+        if (!value) return result;
+        result.emplace_back(start, *value);
+        auto time = start;
+        while (auto next_time = get_next_value_change_time(signal_id, time)) {
+            if (*next_time > end) break;
+            value = get_signal_value(signal_id, *next_time);
+            if (value) result.emplace_back(*next_time, *value);
+            time = *next_time;
+        }
+        return result;
+    }
     inline virtual std::pair<std::string, std::string> compute_instance_mapping(
         const std::unordered_set<std::string> &instance_names) {
         return {};